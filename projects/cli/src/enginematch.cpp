@@ -16,6 +16,7 @@
 */
 
 #include "enginematch.h"
+#include <QCoreApplication>
 #include <QMultiMap>
 #include <chessplayer.h>
 #include <playerbuilder.h>
@@ -24,6 +25,7 @@
 #include <tournament.h>
 #include <gamemanager.h>
 #include <sprt.h>
+#include <board/syzygytablebase.h>
 
 
 EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
@@ -32,15 +34,19 @@ EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
 	  m_debug(false),
 	  m_ratingInterval(0),
 	  m_outcomeInterval(0),
-	  m_bookMode(OpeningBook::Ram)
+	  m_bookMode(OpeningBook::Ram),
+	  m_printCount(0),
+	  m_nextPrint(0)
 {
 	Q_ASSERT(tournament != nullptr);
 
+	m_printPool.setMaxThreadCount(1);
 	m_startTime.start();
 }
 
 EngineMatch::~EngineMatch()
 {
+	m_printPool.waitForDone();
 	qDeleteAll(m_books);
 }
 
@@ -111,11 +117,11 @@ void EngineMatch::onGameStarted(ChessGame* game, int number)
 {
 	Q_ASSERT(game != nullptr);
 
-	qInfo("Started game %d of %d (%s vs %s)",
-	      number,
-	      m_tournament->finalGameCount(),
-	      qUtf8Printable(game->player(Chess::Side::White)->name()),
-	      qUtf8Printable(game->player(Chess::Side::Black)->name()));
+	printInfo(QString("Started game %1 of %2 (%3 vs %4)")
+		  .arg(number)
+		  .arg(m_tournament->finalGameCount())
+		  .arg(game->player(Chess::Side::White)->name(),
+		       game->player(Chess::Side::Black)->name()));
 }
 
 void EngineMatch::onGameFinished(ChessGame* game, int number)
@@ -123,23 +129,23 @@ void EngineMatch::onGameFinished(ChessGame* game, int number)
 	Q_ASSERT(game != nullptr);
 
 	Chess::Result result(game->result());
-	qInfo("Finished game %d (%s vs %s): %s",
-	      number,
-	      qUtf8Printable(game->player(Chess::Side::White)->name()),
-	      qUtf8Printable(game->player(Chess::Side::Black)->name()),
-	      qUtf8Printable(result.toVerboseString()));
+	printInfo(QString("Finished game %1 (%2 vs %3): %4")
+		  .arg(number)
+		  .arg(game->player(Chess::Side::White)->name(),
+		       game->player(Chess::Side::Black)->name(),
+		       result.toVerboseString()));
 
 	if (m_tournament->playerCount() == 2)
 	{
 		TournamentPlayer fcp = m_tournament->playerAt(0);
 		TournamentPlayer scp = m_tournament->playerAt(1);
 		int totalResults = fcp.gamesFinished();
-		qInfo("Score of %s vs %s: %d - %d - %d  [%.3f] %d",
-		      qUtf8Printable(fcp.name()),
-		      qUtf8Printable(scp.name()),
-		      fcp.wins(), scp.wins(), fcp.draws(),
-		      double(fcp.score()) / (totalResults * 2),
-		      totalResults);
+		printInfo(QString::asprintf("Score of %s vs %s: %d - %d - %d  [%.3f] %d",
+					    qUtf8Printable(fcp.name()),
+					    qUtf8Printable(scp.name()),
+					    fcp.wins(), scp.wins(), fcp.draws(),
+					    double(fcp.score()) / (totalResults * 2),
+					    totalResults));
 	}
 
 	if (m_ratingInterval != 0
@@ -158,28 +164,94 @@ void EngineMatch::onTournamentFinished()
 	if (m_outcomeInterval == 0
 	||  m_tournament->finishedGameCount() % m_outcomeInterval != 0)
 		printOutcomes();
+	flushPrints();
 
 	QString error = m_tournament->errorString();
 	if (!error.isEmpty())
 		qWarning("%s", qUtf8Printable(error));
 
+	GameManager* manager = m_tournament->gameManager();
+	if (manager->threadPoolSize() > 0)
+		qInfo("Thread pool utilization: %.1f%% of %d threads",
+		      manager->threadPoolUtilization() * 100.0,
+		      manager->threadPoolSize());
+
+	auto tbStats = SyzygyTablebase::probeStats();
+	if (tbStats.probes > 0)
+		qInfo("Tablebase probes: %llu, cache hits: %llu, "
+		      "average probe time: %.1f us",
+		      tbStats.probes, tbStats.cacheHits,
+		      tbStats.time / 1000.0 / tbStats.probes);
+
 	qInfo("Finished match");
-	connect(m_tournament->gameManager(), SIGNAL(finished()),
+	connect(manager, SIGNAL(finished()),
 		this, SIGNAL(finished()));
-	m_tournament->gameManager()->finish();
+	manager->finish();
 }
 
 void EngineMatch::print(const QString& msg)
 {
-	qInfo("%lld %s", m_startTime.elapsed(), qUtf8Printable(msg));
+	printInfo(QString::number(m_startTime.elapsed()) + " " + msg);
 }
 
 void EngineMatch::printRanking()
 {
-	qInfo("%s", qUtf8Printable(m_tournament->results()));
+	// Large result tables are formatted on the print thread so
+	// that the games don't have to wait for them
+	const Tournament::Standings standings(m_tournament->standings());
+	printInBackground([standings]()
+	{
+		return standings.toString();
+	});
 }
 
 void EngineMatch::printOutcomes()
 {
-	qInfo("%s", qUtf8Printable(m_tournament->outcomes()));
+	printInfo(m_tournament->outcomes());
+}
+
+void EngineMatch::printInfo(const QString& msg)
+{
+	printInOrder(m_printCount++, msg);
+}
+
+void EngineMatch::printInBackground(const std::function<QString()>& format)
+{
+	// The message is printed on this object's thread, after the
+	// messages that were printed before it
+	const int number = m_printCount++;
+	m_printPool.start([this, number, format]()
+	{
+		const QString msg(format());
+		QMetaObject::invokeMethod(this, [this, number, msg]()
+		{
+			printInOrder(number, msg);
+		}, Qt::QueuedConnection);
+	});
+}
+
+void EngineMatch::printInOrder(int number, const QString& msg)
+{
+	if (number != m_nextPrint)
+	{
+		m_pendingPrints.insert(number, msg);
+		return;
+	}
+
+	qInfo("%s", qUtf8Printable(msg));
+	m_nextPrint++;
+
+	while (!m_pendingPrints.isEmpty()
+	&&     m_pendingPrints.firstKey() == m_nextPrint)
+	{
+		qInfo("%s", qUtf8Printable(m_pendingPrints.take(m_nextPrint)));
+		m_nextPrint++;
+	}
+}
+
+void EngineMatch::flushPrints()
+{
+	m_printPool.waitForDone();
+	QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+	Q_ASSERT(m_pendingPrints.isEmpty());
 }
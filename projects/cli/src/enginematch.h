@@ -19,10 +19,12 @@
 #ifndef ENGINEMATCH_H
 #define ENGINEMATCH_H
 
+#include <functional>
 #include <QObject>
 #include <QMap>
 #include <QString>
 #include <QElapsedTimer>
+#include <QThreadPool>
 #include <openingbook.h>
 
 class ChessGame;
@@ -59,6 +61,10 @@ class EngineMatch : public QObject
 	private:
 		void printRanking();
 		void printOutcomes();
+		void printInfo(const QString& msg);
+		void printInBackground(const std::function<QString()>& format);
+		void printInOrder(int number, const QString& msg);
+		void flushPrints();
 
 		Tournament* m_tournament;
 		bool m_debug;
@@ -67,6 +73,11 @@ class EngineMatch : public QObject
 		OpeningBook::AccessMode m_bookMode;
 		QMap<QString, OpeningBook*> m_books;
 		QElapsedTimer m_startTime;
+		QThreadPool m_printPool;
+		// Messages are printed in the order of their numbers
+		int m_printCount;
+		int m_nextPrint;
+		QMap<int, QString> m_pendingPrints;
 };
 
 #endif // ENGINEMATCH_H
@@ -26,6 +26,7 @@
 #include <QFile>
 #include <QMetaType>
 #include <QSysInfo>
+#include <QThread>
 
 #include <mersenne.h>
 #include <enginemanager.h>
@@ -38,6 +39,7 @@
 #include <enginetextoption.h>
 #include <openingsuite.h>
 #include <sprt.h>
+#include <binarygamelog.h>
 #include <board/syzygytablebase.h>
 #include <board/result.h>
 
@@ -262,12 +264,15 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-each", QMetaType::QStringList, 1);
 	parser.addOption("-variant", QMetaType::QString, 1, 1);
 	parser.addOption("-concurrency", QMetaType::Int, 1, 1);
+	parser.addOption("-threadpool", QMetaType::Int, 0, 1);
+	parser.addOption("-enginepool", QMetaType::Int, 1, 1);
 	parser.addOption("-draw", QMetaType::QStringList);
 	parser.addOption("-resign", QMetaType::QStringList);
 	parser.addOption("-maxmoves", QMetaType::Int, 1, 1);
 	parser.addOption("-tb", QMetaType::QString, 1, 1);
 	parser.addOption("-tbpieces", QMetaType::Int, 1, 1);
 	parser.addOption("-tbignore50", QMetaType::Bool, 0, 0);
+	parser.addOption("-tbcache", QMetaType::Int, 1, 1);
 	parser.addOption("-event", QMetaType::QString, 1, 1);
 	parser.addOption("-games", QMetaType::Int, 1, 1);
 	parser.addOption("-rounds", QMetaType::Int, 1, 1);
@@ -280,6 +285,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-bookmode", QMetaType::QString);
 	parser.addOption("-pgnout", QMetaType::QStringList, 1, 3);
 	parser.addOption("-epdout", QMetaType::QString, 1, 1);
+	parser.addOption("-binout", QMetaType::QStringList, 1, 2);
+	parser.addOption("-lazysan", QMetaType::Bool, 0, 0);
 	parser.addOption("-repeat", QMetaType::Int, 0, 1);
 	parser.addOption("-noswap", QMetaType::Bool, 0, 0);
 	parser.addOption("-reverse", QMetaType::Bool, 0, 0);
@@ -301,7 +308,6 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		qWarning("Invalid tournament type: %s", qUtf8Printable(ttype));
 		return nullptr;
 	}
-
 	EngineMatch* match = new EngineMatch(tournament, parent);
 
 	QList<EngineData> engines;
@@ -341,6 +347,26 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			if (ok)
 				manager->setConcurrency(value.toInt());
 		}
+		// Share a fixed number of threads between the games
+		else if (name == "-threadpool")
+		{
+			int size = value.toInt(&ok);
+			if (value.typeId() == QMetaType::Bool)
+			{
+				size = QThread::idealThreadCount();
+				ok = true;
+			}
+			ok = ok && size > 0;
+			if (ok)
+				manager->setThreadPoolSize(size);
+		}
+		// Spare engines for engines that need to be restarted
+		else if (name == "-enginepool")
+		{
+			ok = value.toInt() >= 0;
+			if (ok)
+				manager->setEnginePoolSize(value.toInt());
+		}
 		// Threshold for draw adjudication
 		else if (name == "-draw")
 		{
@@ -399,6 +425,13 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// Syzygy ignore 50-move-rule
 		else if (name == "-tbignore50")
 			SyzygyTablebase::setNoRule50();
+		// Syzygy probe result cache size in megabytes
+		else if (name == "-tbcache")
+		{
+			ok = value.toInt() >= 0 && value.toInt() <= 1024;
+			if (ok)
+				SyzygyTablebase::setCacheSize(value.toInt() * (1024 * 1024 / 8));
+		}
 		// Event name
 		else if (name == "-event")
 			tournament->setName(value.toString());
@@ -431,7 +464,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// SPRT-based stopping rule
 		else if (name == "-sprt")
 		{
-			QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta");
+			QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta|model=trinomial|drain=false");
 			bool sprtOk[4];
 			double elo0 = params["elo0"].toDouble(sprtOk);
 			double elo1 = params["elo1"].toDouble(sprtOk + 1);
@@ -439,8 +472,25 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			double beta = params["beta"].toDouble(sprtOk + 3);
 
 			ok = (sprtOk[0] && sprtOk[1] && sprtOk[2] && sprtOk[3]);
+
+			Sprt::Model model = Sprt::Trinomial;
+			if (params["model"] == "trinomial")
+				model = Sprt::Trinomial;
+			else if (params["model"] == "pentanomial")
+				model = Sprt::Pentanomial;
+			else if (ok)
+			{
+				qWarning("Invalid SPRT model: \"%s\"",
+					 qUtf8Printable(params["model"]));
+				ok = false;
+			}
+
 			if (ok)
+			{
 				tournament->sprt()->initialize(elo0, elo1, alpha, beta);
+				tournament->sprt()->setModel(model);
+				tournament->setSprtDrainEnabled(params["drain"] == "true");
+			}
 		}
 		// Interval for rating list updates
 		else if (name == "-ratinginterval")
@@ -492,7 +542,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		else if (name == "-openings")
 		{
 			QMap<QString, QString> params =
-				option.toMap("file|format=pgn|order=sequential|plies=1024|start=1|policy=default");
+				option.toMap("file|format=pgn|order=sequential|plies=1024|start=1|policy=default|cache=false|saveindex=false");
 			ok = !params.isEmpty();
 
 			OpeningSuite::Format format = OpeningSuite::EpdFormat;
@@ -547,7 +597,12 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 								       format,
 								       order,
 								       start - 1);
-				if (order == OpeningSuite::RandomOrder)
+				const bool cache = params["cache"] == "true";
+				suite->setCacheEnabled(cache, plies);
+				suite->setIndexSavingEnabled(params["saveindex"] == "true");
+				if (cache)
+					qInfo("Loading opening suite...");
+				else if (order == OpeningSuite::RandomOrder)
 					qInfo("Indexing opening suite...");
 				ok = suite->initialize();
 				if (ok)
@@ -563,6 +618,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 				match->setBookMode(OpeningBook::Ram);
 			else if (val == "disk")
 				match->setBookMode(OpeningBook::Disk);
+			else if (val == "mmap")
+				match->setBookMode(OpeningBook::Mmap);
 			else
 				ok = false;
 		}
@@ -592,6 +649,24 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			QString fileName = value.toString();
 			tournament->setEpdOutput(fileName);
 		}
+		// Binary game log output
+		else if (name == "-binout")
+		{
+			QStringList list = value.toStringList();
+			bool evaluations = false;
+			if (list.size() == 2)
+			{
+				if (list.at(1) == "evals")
+					evaluations = true;
+				else
+					ok = false;
+			}
+			if (ok)
+				tournament->setBinaryOutput(list.at(0), evaluations);
+		}
+		// Generate the move strings only when the game ends
+		else if (name == "-lazysan")
+			tournament->setLazySan(true);
 		// Play every opening twice (default), or multiple times
 		else if (name == "-repeat")
 		{
@@ -720,6 +795,15 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		ok = false;
 	}
 
+	if (!tournament->sprt()->isNull()
+	&&  tournament->sprt()->model() == Sprt::Pentanomial
+	&&  !tournament->playsGamePairs())
+	{
+		qWarning("The pentanomial SPRT model needs game pairs, "
+			 "use -repeat and an even number of games");
+		ok = false;
+	}
+
 	if (!ok)
 	{
 		delete match;
@@ -732,6 +816,81 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	return match;
 }
 
+int convertBinaryLog(const QStringList& args)
+{
+	if (args.size() < 2 || args.size() > 3
+	||  (args.size() == 3 && args.at(2) != "min"))
+	{
+		qWarning("Usage: -binconvert INFILE OUTFILE [min]");
+		return 1;
+	}
+	const PgnGame::PgnMode mode = (args.size() == 3) ?
+		PgnGame::Minimal : PgnGame::Verbose;
+
+	QFile in(args.at(0));
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qWarning("Could not open file %s", qUtf8Printable(args.at(0)));
+		return 1;
+	}
+	BinaryGameLog log(&in);
+	if (!log.readHeader())
+	{
+		qWarning("%s is not a binary game log", qUtf8Printable(args.at(0)));
+		return 1;
+	}
+
+	QFile out(args.at(1));
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		qWarning("Could not open file %s", qUtf8Printable(args.at(1)));
+		return 1;
+	}
+	QTextStream stream(&out);
+
+	int count = 0;
+	while (!log.atEnd())
+	{
+		PgnGame game;
+		if (!log.read(&game))
+		{
+			qWarning("Could not read game %d", count + 1);
+			return 1;
+		}
+		if (!game.write(stream, mode))
+		{
+			qWarning("Could not write game %d", count + 1);
+			return 1;
+		}
+		count++;
+	}
+
+	return 0;
+}
+
+int buildOpeningIndex(const QStringList& args)
+{
+	if (args.isEmpty() || args.size() > 2
+	||  (args.size() == 2 && args.at(1) != "pgn" && args.at(1) != "epd"))
+	{
+		qWarning("Usage: -openingindex FILE [pgn|epd]");
+		return 1;
+	}
+	const OpeningSuite::Format format =
+		(args.size() == 2 && args.at(1) == "epd") ?
+		OpeningSuite::EpdFormat : OpeningSuite::PgnFormat;
+
+	qInfo("Indexing opening suite...");
+	if (!OpeningSuite::buildIndex(args.at(0), format))
+	{
+		qWarning("Could not write opening suite index %s",
+			 qUtf8Printable(OpeningSuite::indexFileName(args.at(0))));
+		return 1;
+	}
+
+	return 0;
+}
+
 } // anonymous namespace
 
 int main(int argc, char* argv[])
@@ -784,6 +943,13 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	// Convert a binary game log to PGN
+	if (!arguments.isEmpty() && arguments.first() == "-binconvert")
+		return convertBinaryLog(arguments.mid(1));
+	// Build the index of an opening suite
+	if (!arguments.isEmpty() && arguments.first() == "-openingindex")
+		return buildOpeningIndex(arguments.mid(1));
+
 	s_match = parseMatch(arguments, &app);
 	if (s_match == nullptr)
 		return 1;
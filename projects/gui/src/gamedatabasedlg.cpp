@@ -30,6 +30,7 @@
 #include <pgnstream.h>
 #include <pgngame.h>
 #include <pgngameentry.h>
+#include <pgngameentrystore.h>
 #include <polyglotbook.h>
 
 #include "pgndatabasemodel.h"
@@ -115,8 +116,8 @@ PgnGame PgnGameIterator::next(bool* ok, int depth)
 		return game;
 	}
 
-	const PgnGameEntry* entry = m_dlg->m_pgnGameEntryModel->entryAt(m_gameIndex++);
-	*ok = m_in.seek(entry->pos(), entry->lineNumber()) && game.read(m_in, depth);
+	const PgnGameEntry entry = m_dlg->m_pgnGameEntryModel->entryAt(m_gameIndex++);
+	*ok = m_in.seek(entry.pos(), entry.lineNumber()) && game.read(m_in, depth);
 
 	return game;
 }
@@ -318,6 +319,8 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 		ui->m_copyFenBtn->setText(tr("Copy FEN"));
 	});
 
+	connect(ui->m_findPositionBtn, SIGNAL(clicked()), this, SLOT(findPosition()));
+
 	connect(ui->m_databasesListView->selectionModel(),
 		SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
 		this, SLOT(databaseSelectionChanged(const QItemSelection&, const QItemSelection&)));
@@ -331,6 +334,8 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 
 	connect(ui->m_clearBtn, SIGNAL(clicked()),
 		this, SLOT(updateSearch()));
+	connect(ui->m_clearBtn, &QPushButton::clicked,
+		m_pgnGameEntryModel, &PgnGameEntryModel::clearPositionFilter);
 
 	connect(ui->m_advancedSearchBtn, SIGNAL(clicked()),
 		this, SLOT(onAdvancedSearch()));
@@ -360,13 +365,15 @@ void GameDatabaseDialog::databaseSelectionChanged(const QItemSelection& selected
 	for (const QModelIndex& index : selectedIndexes)
 		m_selectedDatabases[index.row()] = m_dbManager->databases().at(index.row());
 
+	m_pgnGameEntryModel->clearPositionFilter();
+
 	if (m_selectedDatabases.isEmpty())
 	{
-		m_pgnGameEntryModel->setEntries(QList<const PgnGameEntry*>());
+		m_pgnGameEntryModel->setEntries(PgnGameEntryStore());
 		return;
 	}
 
-	QList<const PgnGameEntry*> entries;
+	PgnGameEntryStore entries;
 	QMap<int, PgnDatabase*>::const_iterator it;
 	for (it = m_selectedDatabases.constBegin(); it != m_selectedDatabases.constEnd(); ++it)
 		entries.append(it.value()->entries());
@@ -384,15 +391,14 @@ void GameDatabaseDialog::gameSelectionChanged(const QModelIndex& current,
 		return;
 
 	int databaseIndex;
-	if ((databaseIndex = databaseIndexFromGame(current.row())) == -1)
+	int entryIndex;
+	if ((databaseIndex = databaseIndexFromGame(current.row(), &entryIndex)) == -1)
 		return;
 
 	PgnDatabase* selectedDatabase = m_dbManager->databases().at(databaseIndex);
 
 	PgnDatabase::Status status;
-	const PgnGameEntry* entry = m_pgnGameEntryModel->entryAt(current.row());
-
-	if ((status = selectedDatabase->game(entry, &m_game)) != PgnDatabase::Ok)
+	if ((status = selectedDatabase->game(entryIndex, &m_game)) != PgnDatabase::Ok)
 	{
 		if (status == PgnDatabase::DoesNotExist)
 		{
@@ -479,7 +485,7 @@ void GameDatabaseDialog::onAdvancedSearch()
 	ui->m_clearBtn->setEnabled(true);
 }
 
-int GameDatabaseDialog::databaseIndexFromGame(int game) const
+int GameDatabaseDialog::databaseIndexFromGame(int game, int* entryIndex) const
 {
 	if (m_selectedDatabases.isEmpty())
 		return -1;
@@ -489,9 +495,14 @@ int GameDatabaseDialog::databaseIndexFromGame(int game) const
 	QMap<int, PgnDatabase*>::const_iterator it;
 	for (it = m_selectedDatabases.constBegin(); it != m_selectedDatabases.constEnd(); ++it)
 	{
-		game -= it.value()->entries().count();
-		if (game < 0)
+		const int count = it.value()->entries().count();
+		if (game < count)
+		{
+			if (entryIndex != nullptr)
+				*entryIndex = game;
 			return it.key();
+		}
+		game -= count;
 	}
 
 	return -1;
@@ -572,6 +583,43 @@ void GameDatabaseDialog::copyFen()
 	ui->m_copyFenBtn->setText(tr("Copied"));
 }
 
+void GameDatabaseDialog::findPosition()
+{
+	if (m_game.isNull() || m_gameViewer->board() == nullptr)
+		return;
+
+	const quint64 key = m_gameViewer->board()->key();
+	QList<int> games;
+	bool indexed = false;
+	int offset = 0;
+
+	// The model sees the selected databases as one list of entries
+	for (const PgnDatabase* db : std::as_const(m_selectedDatabases))
+	{
+		if (db->hasPositionIndex())
+		{
+			indexed = true;
+			const auto dbGames = db->gamesWithPosition(key);
+			for (int game : dbGames)
+				games.append(offset + game);
+		}
+		offset += db->entries().count();
+	}
+
+	if (!indexed)
+	{
+		QMessageBox::information(this, tr("Find Position"),
+			tr("The selected databases have no position index.\n"
+			   "Enable position indexing in the settings and "
+			   "import the databases again."));
+		return;
+	}
+
+	ui->m_searchEdit->setText(tr("[Position search]"));
+	ui->m_clearBtn->setEnabled(true);
+	m_pgnGameEntryModel->setPositionFilter(games);
+}
+
 void GameDatabaseDialog::updateUi()
 {
 	bool enable = m_pgnGameEntryModel->rowCount() > 0;
@@ -579,6 +627,7 @@ void GameDatabaseDialog::updateUi()
 	ui->m_exportBtn->setEnabled(enable);
 	ui->m_copyGameBtn->setEnabled(enable);
 	ui->m_copyFenBtn->setEnabled(enable);
+	ui->m_findPositionBtn->setEnabled(enable);
 }
 
 #include "gamedatabasedlg.moc"
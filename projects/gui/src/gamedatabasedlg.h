@@ -63,11 +63,12 @@ class GameDatabaseDialog : public QDialog
 		void createOpeningBook();
 		void copyGame();
 		void copyFen();
+		void findPosition();
 		void updateUi();
 
 	private:
 		friend class PgnGameIterator;
-		int databaseIndexFromGame(int game) const;
+		int databaseIndexFromGame(int game, int* entryIndex = nullptr) const;
 
 		GameViewer* m_gameViewer;
 		PgnGame m_game;
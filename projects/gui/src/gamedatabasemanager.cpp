@@ -21,8 +21,10 @@
 #include <QFileInfo>
 #include <QDataStream>
 #include <QThreadPool>
+#include <QSettings>
 
 #include <pgngameentry.h>
+#include <pgngameentrystore.h>
 
 #include "pgndatabase.h"
 #include "pgnimporter.h"
@@ -31,6 +33,8 @@
 
 #define GAME_DATABASE_STATE_MAGIC   0xDEADD00D
 #define GAME_DATABASE_STATE_VERSION 1
+#define GAME_DATABASE_INDEX_MAGIC   0xDEADD00E
+#define GAME_DATABASE_INDEX_VERSION 1
 
 GameDatabaseManager::GameDatabaseManager(QObject* parent)
 	: QObject(parent),
@@ -73,14 +77,14 @@ bool GameDatabaseManager::writeState(const QString& fileName)
 		out << db->displayName();
 		out << (qint32)db->entries().count();
 
-		const auto entries = db->entries();
-		for (const PgnGameEntry* entry : entries)
-			entry->write(out);
+		const PgnGameEntryStore& entries = db->entries();
+		for (int j = 0; j < entries.count(); j++)
+			entries.write(j, out);
 	}
 
 	m_modified = false;
 
-	return true;
+	return writePositionIndexes(positionIndexFileName(fileName));
 }
 
 bool GameDatabaseManager::readState(const QString& fileName)
@@ -151,12 +155,13 @@ bool GameDatabaseManager::readState(const QString& fileName)
 		in >> dbEntryCount;
 
 		// Read the entries
-		QList<const PgnGameEntry*> entries;
+		PgnGameEntryStore entries;
+		PgnGameEntry entry;
+		entries.reserve(dbEntryCount);
 		for (int j = 0; j < dbEntryCount; j++)
 		{
-			PgnGameEntry* entry = new PgnGameEntry;
-			entry->read(in);
-			entries << entry;
+			entry.read(in);
+			entries.append(entry);
 		}
 
 		PgnDatabase* db = new PgnDatabase(dbFileName);
@@ -170,14 +175,120 @@ bool GameDatabaseManager::readState(const QString& fileName)
 	m_modified = false;
 
 	m_databases = readDatabases;
+	readPositionIndexes(positionIndexFileName(fileName));
 	emit databasesReset();
 
 	return true;
 }
 
+QString GameDatabaseManager::positionIndexFileName(const QString& stateFileName)
+{
+	return stateFileName + QLatin1String(".idx");
+}
+
+bool GameDatabaseManager::writePositionIndexes(const QString& fileName) const
+{
+	QList<const PgnDatabase*> indexed;
+	for (const PgnDatabase* db : std::as_const(m_databases))
+	{
+		if (db->hasPositionIndex())
+			indexed << db;
+	}
+
+	if (indexed.isEmpty())
+	{
+		QFile::remove(fileName);
+		return true;
+	}
+
+	QFile indexFile(fileName);
+	if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	QDataStream out(&indexFile);
+	out.setVersion(QDataStream::Qt_4_6); // don't change
+
+	out << (quint32)GAME_DATABASE_INDEX_MAGIC;
+	out << (quint32)GAME_DATABASE_INDEX_VERSION;
+	out << (qint32)indexed.count();
+
+	// The indexes are matched to the databases by file name and
+	// modification time, so a stale index is never used
+	for (const PgnDatabase* db : std::as_const(indexed))
+	{
+		out << db->fileName();
+		out << db->lastModified();
+		out << (qint32)db->entries().count();
+		db->writePositionIndex(out);
+	}
+
+	return out.status() == QDataStream::Ok;
+}
+
+bool GameDatabaseManager::readPositionIndexes(const QString& fileName)
+{
+	QFile indexFile(fileName);
+	if (!indexFile.open(QIODevice::ReadOnly))
+		return false;
+
+	QDataStream in(&indexFile);
+	in.setVersion(QDataStream::Qt_4_6); // don't change
+
+	quint32 magic;
+	quint32 version;
+	in >> magic >> version;
+
+	if (magic != GAME_DATABASE_INDEX_MAGIC
+	||  version != GAME_DATABASE_INDEX_VERSION)
+	{
+		qWarning("GameDatabaseManager: invalid position index file");
+		return false;
+	}
+
+	qint32 indexCount;
+	in >> indexCount;
+
+	QString dbFileName;
+	QDateTime dbLastModified;
+	qint32 dbEntryCount;
+
+	for (int i = 0; i < indexCount; i++)
+	{
+		in >> dbFileName;
+		in >> dbLastModified;
+		in >> dbEntryCount;
+
+		PgnDatabase* target = nullptr;
+		for (PgnDatabase* db : std::as_const(m_databases))
+		{
+			if (db->fileName() == dbFileName
+			&&  db->lastModified() == dbLastModified
+			&&  db->entries().count() == dbEntryCount
+			&&  !db->hasPositionIndex())
+			{
+				target = db;
+				break;
+			}
+		}
+
+		PgnDatabase dummy(dbFileName);
+		if (target == nullptr)
+			target = &dummy;
+		if (!target->readPositionIndex(in))
+		{
+			qWarning("GameDatabaseManager: corrupted position index file");
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void GameDatabaseManager::importPgnFile(const QString& fileName)
 {
-	PgnImporter* pgnImporter = new PgnImporter(fileName);
+	bool indexPositions = QSettings()
+		.value("games/index_database_positions", false).toBool();
+	PgnImporter* pgnImporter = new PgnImporter(fileName, indexPositions);
 	connect(pgnImporter, SIGNAL(databaseRead(PgnDatabase*)),
 		this, SLOT(addDatabase(PgnDatabase*)));
 
@@ -48,7 +48,11 @@ class GameDatabaseManager : public QObject
 		/*!
 		 * Writes the state to a file pointed by \a fileName.
 		 *
+		 * The position indexes of the databases are written to a
+		 * separate file next to the state file.
+		 *
 		 * \sa readState
+		 * \sa positionIndexFileName
 		 */
 		bool writeState(const QString& fileName);
 		/*!
@@ -58,6 +62,12 @@ class GameDatabaseManager : public QObject
 		 */
 		bool readState(const QString& fileName);
 
+		/*!
+		 * Returns the name of the position index file that
+		 * accompanies the state file \a stateFileName.
+		 */
+		static QString positionIndexFileName(const QString& stateFileName);
+
 		/*! Returns true if the current state has been modified. */
 		bool isModified() const;
 
@@ -80,6 +90,9 @@ class GameDatabaseManager : public QObject
 		/*!
 		 * Imports a game database pointed by \a fileName in PGN format.
 		 *
+		 * A position index is built for the database if the
+		 * \c games/index_database_positions setting is enabled.
+		 *
 		 * This function is asynchronous and thus returns immediately.
 		 *
 		 * \sa importStarted
@@ -109,6 +122,9 @@ class GameDatabaseManager : public QObject
 		void databasesReset();
 
 	private:
+		bool writePositionIndexes(const QString& fileName) const;
+		bool readPositionIndexes(const QString& fileName);
+
 		QList<PgnDatabase*> m_databases;
 		bool m_modified;
 
@@ -31,6 +31,7 @@
 #include <QWindow>
 #include <QSettings>
 #include <QSysInfo>
+#include <QTextStream>
 
 #include <board/boardfactory.h>
 #include <chessgame.h>
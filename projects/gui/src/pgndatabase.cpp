@@ -17,11 +17,14 @@
 */
 
 #include "pgndatabase.h"
+#include <algorithm>
 #include <pgnstream.h>
 #include <QFileInfo>
+#include <QDataStream>
 
 PgnDatabase::PgnDatabase(const QString& fileName, QObject* parent)
 	: QObject(parent),
+	  m_hasPositionIndex(false),
 	  m_fileName(fileName),
 	  m_displayName(QFileInfo(fileName).completeBaseName())
 {
@@ -29,16 +32,14 @@ PgnDatabase::PgnDatabase(const QString& fileName, QObject* parent)
 
 PgnDatabase::~PgnDatabase()
 {
-	qDeleteAll(m_entries);
 }
 
-void PgnDatabase::setEntries(const QList<const PgnGameEntry*>& entries)
+void PgnDatabase::setEntries(const PgnGameEntryStore& entries)
 {
-	qDeleteAll(m_entries);
 	m_entries = entries;
 }
 
-QList<const PgnGameEntry*> PgnDatabase::entries() const
+const PgnGameEntryStore& PgnDatabase::entries() const
 {
 	return m_entries;
 }
@@ -82,10 +83,9 @@ void PgnDatabase::setDisplayName(const QString& displayName)
 	m_displayName = displayName;
 }
 
-PgnDatabase::Status PgnDatabase::game(const PgnGameEntry* entry,
-				      PgnGame* game)
+PgnDatabase::Status PgnDatabase::game(int index, PgnGame* game)
 {
-	Q_ASSERT(entry != nullptr);
+	Q_ASSERT(index >= 0 && index < m_entries.count());
 	Q_ASSERT(game != nullptr);
 
 	Status status = this->status();
@@ -97,8 +97,76 @@ PgnDatabase::Status PgnDatabase::game(const PgnGameEntry* entry,
 		return Unreadable;
 
 	PgnStream in(&file);
-	if (!in.seek(entry->pos(), entry->lineNumber()) || !game->read(in))
+	if (!in.seek(m_entries.pos(index), m_entries.lineNumber(index))
+	||  !game->read(in))
 		return Corrupted;
 
 	return Ok;
 }
+
+bool PgnDatabase::hasPositionIndex() const
+{
+	return m_hasPositionIndex;
+}
+
+QVector<PgnDatabase::PositionIndexEntry> PgnDatabase::positionIndex() const
+{
+	return m_positionIndex;
+}
+
+void PgnDatabase::setPositionIndex(const QVector<PositionIndexEntry>& index)
+{
+	m_positionIndex = index;
+	if (!std::is_sorted(m_positionIndex.begin(), m_positionIndex.end()))
+		std::sort(m_positionIndex.begin(), m_positionIndex.end());
+	m_positionIndex.erase(std::unique(m_positionIndex.begin(),
+					  m_positionIndex.end()),
+			      m_positionIndex.end());
+	m_positionIndex.squeeze();
+	m_hasPositionIndex = true;
+}
+
+QList<int> PgnDatabase::gamesWithPosition(quint64 key) const
+{
+	QList<int> games;
+
+	const PositionIndexEntry first = { key, 0 };
+	auto it = std::lower_bound(m_positionIndex.constBegin(),
+				   m_positionIndex.constEnd(), first);
+	for (; it != m_positionIndex.constEnd() && it->key == key; ++it)
+	{
+		if (it->game >= 0 && it->game < m_entries.count())
+			games.append(it->game);
+	}
+
+	return games;
+}
+
+void PgnDatabase::writePositionIndex(QDataStream& out) const
+{
+	out << (qint32)m_positionIndex.size();
+	for (const PositionIndexEntry& entry : m_positionIndex)
+		out << entry.key << entry.game;
+}
+
+bool PgnDatabase::readPositionIndex(QDataStream& in)
+{
+	qint32 count;
+	in >> count;
+	if (in.status() != QDataStream::Ok || count < 0)
+		return false;
+
+	QVector<PositionIndexEntry> index;
+	index.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		PositionIndexEntry entry;
+		in >> entry.key >> entry.game;
+		index.append(entry);
+	}
+	if (in.status() != QDataStream::Ok)
+		return false;
+
+	setPositionIndex(index);
+	return true;
+}
@@ -21,17 +21,20 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 #include <QDateTime>
 #include <QFile>
 #include <pgngame.h>
 #include <pgngameentry.h>
+#include <pgngameentrystore.h>
 class PgnStream;
+class QDataStream;
 
 /*!
  * \brief PGN database
  *
  * \sa PgnGame
- * \sa PgnGameEntry
+ * \sa PgnGameEntryStore
  * \sa PgnImporter
  */
 class PgnDatabase : public QObject
@@ -54,25 +57,46 @@ class PgnDatabase : public QObject
 		 * the underlying database.
 		 */
 		PgnDatabase(const QString& fileName, QObject* parent = nullptr);
-		/*! Destroys the database and the game entries it contains. */
+		/*! Destroys the database. */
 		virtual ~PgnDatabase();
 
 		/*!
-		 * Set the game entries found in this database to \a entries.
+		 * \brief An entry in the position index.
 		 *
-		 * The database takes ownership of the PgnGameEntry objects
-		 * in \a entries.
+		 * Maps the Zobrist key of a position to the index of a game
+		 * in entries() where the position occurs.
 		 */
-		void setEntries(const QList<const PgnGameEntry*>& entries);
+		struct PositionIndexEntry
+		{
+			/*! Zobrist key of the position. */
+			quint64 key;
+			/*! Index of the game in entries(). */
+			qint32 game;
+
+			/*! Orders the entries by key, then by game. */
+			bool operator<(const PositionIndexEntry& other) const
+			{
+				return key < other.key
+				    || (key == other.key && game < other.game);
+			}
+			/*! Returns true if both entries are equal. */
+			bool operator==(const PositionIndexEntry& other) const
+			{
+				return key == other.key && game == other.game;
+			}
+		};
+
+		/*! Set the game entries found in this database to \a entries. */
+		void setEntries(const PgnGameEntryStore& entries);
 		/*!
-		 * Returns the list of game entries in this database.
+		 * Returns the game entries in this database.
 		 *
 		 * Game entries are light-weight "pointers" to the database. The game()
 		 * method can be used to read the move information.
 		 *
 		 * \sa game()
 		 */
-		QList<const PgnGameEntry*> entries() const;
+		const PgnGameEntryStore& entries() const;
 
 		/*! Returns the file name of this database. */
 		QString fileName() const;
@@ -115,14 +139,60 @@ class PgnDatabase : public QObject
 		void setDisplayName(const QString& displayName);
 
 		/*!
-		 * Reads \a game from the database using \a entry.
+		 * Reads \a game from the database using the entry at
+		 * \a index in entries().
 		 *
 		 * \note \a game must be allocated by the caller and must not be NULL.
 		 */
-		Status game(const PgnGameEntry* entry, PgnGame* game);
+		Status game(int index, PgnGame* game);
+
+		/*!
+		 * Returns true if this database has a position index.
+		 *
+		 * \sa setPositionIndex
+		 */
+		bool hasPositionIndex() const;
+		/*!
+		 * Returns the position index of this database.
+		 *
+		 * The index is sorted and contains no duplicates.
+		 */
+		QVector<PositionIndexEntry> positionIndex() const;
+		/*!
+		 * Sets the position index of this database to \a index.
+		 *
+		 * \a index is sorted and stripped of duplicates if necessary.
+		 * The game indexes in \a index refer to entries().
+		 */
+		void setPositionIndex(const QVector<PositionIndexEntry>& index);
+		/*!
+		 * Returns the indexes in entries() of the games in which the
+		 * position with Zobrist key \a key occurs.
+		 *
+		 * Returns an empty list if the position is not found or if
+		 * the database doesn't have a position index.
+		 */
+		QList<int> gamesWithPosition(quint64 key) const;
+
+		/*!
+		 * Writes the position index to \a out.
+		 *
+		 * \sa readPositionIndex
+		 */
+		void writePositionIndex(QDataStream& out) const;
+		/*!
+		 * Reads the position index from \a in.
+		 *
+		 * Returns false if the index is corrupted.
+		 *
+		 * \sa writePositionIndex
+		 */
+		bool readPositionIndex(QDataStream& in);
 
 	private:
-		QList<const PgnGameEntry*> m_entries;
+		PgnGameEntryStore m_entries;
+		QVector<PositionIndexEntry> m_positionIndex;
+		bool m_hasPositionIndex;
 		QDateTime m_lastModified;
 		QString m_fileName;
 		QString m_displayName;
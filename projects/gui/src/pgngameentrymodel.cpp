@@ -18,36 +18,41 @@
 
 #include "pgngameentrymodel.h"
 #include <QtConcurrentFilter>
-#include <pgngameentry.h>
+#include <pgngameentrystore.h>
 
 
 struct EntryContains
 {
-	EntryContains(const QList<const PgnGameEntry*>& entries,
-		      const PgnGameFilter& filter)
-		: m_entries(entries), m_filter(filter) { }
+	EntryContains(const PgnGameEntryStore& entries,
+		      const PgnGameFilter& filter,
+		      const QSet<int>* games)
+		: m_entries(entries), m_filter(filter), m_games(games) { }
 
 	typedef bool result_type;
 
 	inline bool operator()(int index)
 	{
-		return m_entries.at(index)->match(m_filter);
+		if (m_games != nullptr && !m_games->contains(index))
+			return false;
+		return m_entries.match(index, m_filter);
 	}
 
-	const QList<const PgnGameEntry*>& m_entries;
+	const PgnGameEntryStore& m_entries;
 	PgnGameFilter m_filter;
+	const QSet<int>* m_games;
 };
 
 
 PgnGameEntryModel::PgnGameEntryModel(QObject* parent)
 	: QAbstractItemModel(parent),
-	  m_entryCount(0)
+	  m_entryCount(0),
+	  m_hasPositionFilter(false)
 {
 	connect(&m_watcher, SIGNAL(resultsReadyAt(int,int)),
 		this, SLOT(onResultsReady()));
 }
 
-const PgnGameEntry* PgnGameEntryModel::entryAt(int row) const
+PgnGameEntry PgnGameEntryModel::entryAt(int row) const
 {
 	return m_entries.at(m_filtered.resultAt(row));
 }
@@ -62,17 +67,17 @@ int PgnGameEntryModel::entryCount() const
 	return m_filtered.resultCount();
 }
 
-void PgnGameEntryModel::setEntries(const QList<const PgnGameEntry*>& entries)
+void PgnGameEntryModel::setEntries(const PgnGameEntryStore& entries)
 {
 	m_watcher.cancel();
 	m_watcher.waitForFinished();
 
 	m_entries = entries;
 
-	if (entries.size() > m_indexes.size())
+	if (entries.count() > m_indexes.size())
 	{
-		m_indexes.reserve(entries.size());
-		for (int i = m_indexes.size(); i < entries.size(); i++)
+		m_indexes.reserve(entries.count());
+		for (int i = m_indexes.size(); i < entries.count(); i++)
 			m_indexes.append(i);
 	}
 
@@ -91,8 +96,9 @@ void PgnGameEntryModel::applyFilter(const PgnGameFilter& filter)
 	m_entryCount = 0;
 
 	m_filtered = QtConcurrent::filtered(m_indexes.constBegin(),
-					    m_indexes.constBegin() + m_entries.size(),
-					    EntryContains(m_entries, filter));
+					    m_indexes.constBegin() + m_entries.count(),
+					    EntryContains(m_entries, filter,
+							  m_hasPositionFilter ? &m_positionFilter : nullptr));
 
 	m_watcher.setFuture(m_filtered);
 	endResetModel();
@@ -107,6 +113,29 @@ void PgnGameEntryModel::setFilter(const PgnGameFilter& filter)
 	applyFilter(filter);
 }
 
+void PgnGameEntryModel::setPositionFilter(const QList<int>& games)
+{
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+
+	m_positionFilter = QSet<int>(games.begin(), games.end());
+	m_hasPositionFilter = true;
+	applyFilter(m_filter);
+}
+
+void PgnGameEntryModel::clearPositionFilter()
+{
+	if (!m_hasPositionFilter)
+		return;
+
+	m_watcher.cancel();
+	m_watcher.waitForFinished();
+
+	m_positionFilter.clear();
+	m_hasPositionFilter = false;
+	applyFilter(m_filter);
+}
+
 QModelIndex PgnGameEntryModel::index(int row, int column,
 				 const QModelIndex& parent) const
 {
@@ -150,7 +179,7 @@ QVariant PgnGameEntryModel::data(const QModelIndex& index, int role) const
 	if (role == Qt::DisplayRole || role == Qt::EditRole)
 	{
 		PgnGameEntry::TagType tagType = PgnGameEntry::TagType(index.column());
-		return entryAt(index.row())->tagValue(tagType);
+		return m_entries.tagValue(m_filtered.resultAt(index.row()), tagType);
 	}
 
 	return QVariant();
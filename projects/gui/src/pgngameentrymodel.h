@@ -21,10 +21,11 @@
 
 #include <QAbstractItemModel>
 #include <QList>
+#include <QSet>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <pgngamefilter.h>
-class PgnGameEntry;
+#include <pgngameentrystore.h>
 
 /*!
  * \brief Supplies PGN game entry information to views.
@@ -37,8 +38,8 @@ class PgnGameEntryModel : public QAbstractItemModel
 		/*! Constructs a PGN game entry model with the given \a parent. */
 		PgnGameEntryModel(QObject* parent = nullptr);
 
-		/*! Returns the PGN entry at \a row. */
-		const PgnGameEntry* entryAt(int row) const;
+		/*! Returns a copy of the PGN entry at \a row. */
+		PgnGameEntry entryAt(int row) const;
 		/*!
 		 * Returns the total number of PGN game entries matching the
 		 * current filter.
@@ -53,7 +54,7 @@ class PgnGameEntryModel : public QAbstractItemModel
 		 */
 		int sourceIndex(int row) const;
 		/*! Associates a list of PGN game entries with this model. */
-		void setEntries(const QList<const PgnGameEntry*>& entries);
+		void setEntries(const PgnGameEntryStore& entries);
 
 		// Inherited from QAbstractItemModel
 		virtual QModelIndex index(int row, int column,
@@ -68,6 +69,17 @@ class PgnGameEntryModel : public QAbstractItemModel
 	public slots:
 		/*! Sets the filter for filtering the contents of the database. */
 		void setFilter(const PgnGameFilter& filter);
+		/*!
+		 * Restricts the contents of the model to \a games, which
+		 * are indexes in the entries set with setEntries().
+		 *
+		 * The restriction is applied in addition to the current filter.
+		 *
+		 * \sa clearPositionFilter()
+		 */
+		void setPositionFilter(const QList<int>& games);
+		/*! Removes the restriction set by setPositionFilter(). */
+		void clearPositionFilter();
 
 	protected:
 		// Inherited from QAbstractItemModel
@@ -80,12 +92,14 @@ class PgnGameEntryModel : public QAbstractItemModel
 	private:
 		void applyFilter(const PgnGameFilter& filter);
 
-		QList<const PgnGameEntry*> m_entries;
+		PgnGameEntryStore m_entries;
 		QVector<int> m_indexes;
 		int m_entryCount;
 		QFuture<int> m_filtered;
 		QFutureWatcher<int> m_watcher;
 		PgnGameFilter m_filter;
+		QSet<int> m_positionFilter;
+		bool m_hasPositionFilter;
 };
 
 #endif // PGN_GAME_ENTRY_MODEL_H
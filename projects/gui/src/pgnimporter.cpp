@@ -20,14 +20,21 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+#include <QtConcurrentRun>
 
 #include <pgnstream.h>
+#include <pgngame.h>
 #include <pgngameentry.h>
+#include <pgngameentrystore.h>
+#include <board/board.h>
 #include "pgndatabase.h"
 
-PgnImporter::PgnImporter(const QString& fileName)
+PgnImporter::PgnImporter(const QString& fileName, bool indexPositions)
 	: Worker(QString("PGN import: %1").arg(fileName)),
-	  m_fileName(fileName)
+	  m_fileName(fileName),
+	  m_indexPositions(indexPositions)
 {
 }
 
@@ -36,12 +43,87 @@ QString PgnImporter::fileName() const
 	return m_fileName;
 }
 
+bool PgnImporter::indexPositions() const
+{
+	return m_indexPositions;
+}
+
+namespace {
+
+const qint64 s_minChunkSize = 8 * 1024 * 1024;
+const int s_scanBlockSize = 1024 * 1024;
+
+// Returns true if \a line is an Event tag pair, which starts a game
+bool isEventTag(const QByteArray& line)
+{
+	static const QRegularExpression re(
+		"^\\[Event\\s+\"[^\"]*\"\\s*\\]\\s*$");
+	return line.startsWith("[Event ")
+	    && re.match(QString::fromUtf8(line)).hasMatch();
+}
+
+// Returns the offset of the first game boundary (an Event tag pair at
+// the start of a line that follows an empty line) at or after \a pos,
+// or -1 if there is none.
+qint64 findGameBoundary(QFile* file, qint64 pos)
+{
+	// The line at pos may be incomplete, so it can't be a boundary
+	// but it can be the empty line before one
+	if (!file->seek(qMax<qint64>(0, pos - 1)))
+		return -1;
+	if (pos > 0)
+		file->readLine();
+
+	bool emptyLine = (pos == 0);
+	while (!file->atEnd())
+	{
+		const qint64 lineStart = file->pos();
+		const QByteArray line(file->readLine());
+		if (line.isEmpty())
+			break;
+
+		if (emptyLine && isEventTag(line))
+			return lineStart;
+		emptyLine = line.trimmed().isEmpty();
+	}
+
+	return -1;
+}
+
+// Returns the number of lines between \a start and \a end in \a fileName
+qint64 countLines(const QString& fileName, qint64 start, qint64 end)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(start))
+		return 0;
+
+	qint64 lines = 0;
+	QByteArray block;
+	while (start < end
+	&&     !(block = file.read(qMin<qint64>(s_scanBlockSize, end - start))).isEmpty())
+	{
+		lines += block.count('\n');
+		start += block.size();
+	}
+
+	return lines;
+}
+
+} // anonymous namespace
+
+struct PgnImporter::Chunk
+{
+	qint64 start;
+	qint64 end;
+	qint64 lineNumber;
+	PgnGameEntryStore games;
+	QVector<PgnDatabase::PositionIndexEntry> positionIndex;
+};
+
 void PgnImporter::work()
 {
 	QFile file(m_fileName);
 	QFileInfo fileInfo(m_fileName);
-	static const int updateInterval = 1024;
-	int numReadGames = 0;
 
 	if (!fileInfo.exists())
 	{
@@ -49,34 +131,149 @@ void PgnImporter::work()
 		return;
 	}
 
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	if (!file.open(QIODevice::ReadOnly))
 	{
 		emit error(PgnImporter::IoError);
 		return;
 	}
 
-	PgnStream pgnStream(&file);
-	QList<const PgnGameEntry*> games;
+	// Split the file into chunks at game boundaries
+	const qint64 size = file.size();
+	const int chunkCount = int(qBound<qint64>(1, size / s_minChunkSize,
+						  QThread::idealThreadCount()));
+	QVector<Chunk> chunks(1);
+	chunks[0] = { 0, -1, 1, {}, {} };
 
-	for (;;)
+	for (int i = 1; i < chunkCount; i++)
 	{
-		PgnGameEntry* game = new PgnGameEntry;
-		if (cancelRequested() || !game->read(pgnStream))
-		{
-			delete game;
-			break;
-		}
+		qint64 pos = findGameBoundary(&file, size * i / chunkCount);
+		if (pos <= chunks.last().start)
+			continue;
 
-		games << game;
-		numReadGames++;
+		chunks.last().end = pos;
+		chunks.append({ pos, -1, 1, {}, {} });
+	}
+	file.close();
 
-		if (numReadGames % updateInterval == 0)
-			emit databaseReadStatus(startTime(), numReadGames,
-			    pgnStream.pos());
+	// Count the lines in every chunk so that the games get the
+	// same line numbers as in a sequential import
+	if (chunks.size() > 1)
+	{
+		QList<QFuture<qint64>> lineCounts;
+		for (int i = 0; i < chunks.size() - 1; i++)
+			lineCounts << QtConcurrent::run(countLines, m_fileName,
+							chunks[i].start,
+							chunks[i].end);
+		for (int i = 1; i < chunks.size(); i++)
+			chunks[i].lineNumber = chunks[i - 1].lineNumber
+					     + lineCounts[i - 1].result();
 	}
+
+	m_readGames = 0;
+	m_readBytes = 0;
+
+	QList<QFuture<void>> futures;
+	for (int i = 1; i < chunks.size(); i++)
+		futures << QtConcurrent::run(&PgnImporter::readChunk, this, &chunks[i]);
+	readChunk(&chunks[0]);
+	for (QFuture<void>& future : futures)
+		future.waitForFinished();
+
+	// Merge the chunks in file order
+	PgnGameEntryStore games;
+	QVector<PgnDatabase::PositionIndexEntry> positionIndex;
+	for (const Chunk& chunk : std::as_const(chunks))
+	{
+		const qint32 offset = qint32(games.count());
+		for (const auto& entry : chunk.positionIndex)
+			positionIndex.append({ entry.key, entry.game + offset });
+		games.append(chunk.games);
+	}
+
 	PgnDatabase* db = new PgnDatabase(m_fileName);
 	db->setEntries(games);
+	if (m_indexPositions)
+		db->setPositionIndex(positionIndex);
 	db->setLastModified(fileInfo.lastModified());
 
 	emit databaseRead(db);
 }
+
+void PgnImporter::readChunk(Chunk* chunk)
+{
+	static const int updateInterval = 1024;
+
+	QFile file(m_fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return;
+
+	PgnStream pgnStream(&file);
+	if (!pgnStream.seek(chunk->start, chunk->lineNumber))
+		return;
+
+	PgnGameEntry game;
+	PgnGame pgnGame;
+	qint64 lastPos = chunk->start;
+
+	for (;;)
+	{
+		if (cancelRequested())
+			break;
+
+		// Collect the keys of the positions in which a move was
+		// played and of the final position while reading the game
+		if (m_indexPositions)
+		{
+			if (!pgnStream.nextGame())
+				break;
+			const qint64 pos = pgnStream.pos();
+			const qint64 lineNumber = pgnStream.lineNumber();
+			if (chunk->end != -1 && pos >= chunk->end)
+				break;
+
+			// Games without a Variant tag are standard chess
+			pgnStream.setVariant("standard");
+			if (!pgnGame.read(pgnStream, INT_MAX - 1, false))
+				break;
+			game.setGame(pgnGame, pos, lineNumber);
+
+			const qint32 index = qint32(chunk->games.count());
+			const auto& moves = pgnGame.moves();
+			for (const PgnGame::MoveData& md : moves)
+				chunk->positionIndex.append({ md.key, index });
+			if (!moves.isEmpty())
+				chunk->positionIndex.append({ pgnStream.board()->key(), index });
+		}
+		else if (!game.read(pgnStream)
+		     ||  (chunk->end != -1 && game.pos() >= chunk->end))
+			break;
+
+		chunk->games.append(game);
+
+		if (chunk->games.count() % updateInterval == 0)
+		{
+			const qint64 pos = pgnStream.pos();
+			int numReadGames = m_readGames.fetchAndAddRelaxed(updateInterval)
+					 + updateInterval;
+			qint64 numReadBytes = m_readBytes.fetchAndAddRelaxed(pos - lastPos)
+					    + pos - lastPos;
+			lastPos = pos;
+
+			emit databaseReadStatus(startTime(), numReadGames, numReadBytes);
+		}
+	}
+
+	// Report the games and bytes read since the last update
+	qint64 pos = pgnStream.pos();
+	if (chunk->end != -1)
+		pos = qMin(pos, chunk->end);
+	const int remainingGames = chunk->games.count() % updateInterval;
+	if (remainingGames > 0 || pos > lastPos)
+	{
+		int numReadGames = m_readGames.fetchAndAddRelaxed(remainingGames)
+				 + remainingGames;
+		qint64 numReadBytes = m_readBytes.fetchAndAddRelaxed(pos - lastPos)
+				    + pos - lastPos;
+		emit databaseReadStatus(startTime(), numReadGames, numReadBytes);
+	}
+}
@@ -19,6 +19,7 @@
 #ifndef PGN_IMPORTER_H
 #define PGN_IMPORTER_H
 
+#include <QAtomicInteger>
 #include <worker.h>
 
 class PgnDatabase;
@@ -26,6 +27,9 @@ class PgnDatabase;
 /*!
  * \brief Reads PGN database in a separate thread.
  *
+ * Large files are split into chunks at game boundaries, and the
+ * chunks are read concurrently in the global thread pool.
+ *
  * \sa PgnDatabase
  */
 class PgnImporter : public Worker
@@ -43,10 +47,17 @@ class PgnImporter : public Worker
 		/*!
 		 * Constructs a PgnImporter with \a fileName as
 		 * database to be imported.
+		 *
+		 * If \a indexPositions is true the moves of every game are
+		 * parsed and a position index is built for the database.
+		 *
+		 * \sa PgnDatabase::gamesWithPosition()
 		 */
-		PgnImporter(const QString& fileName);
+		PgnImporter(const QString& fileName, bool indexPositions = false);
 		/*! Returns the file name of the database to be imported. */
 		QString fileName() const;
+		/*! Returns true if a position index is built during import. */
+		bool indexPositions() const;
 
 	protected:
 		void work() override;
@@ -63,7 +74,13 @@ class PgnImporter : public Worker
 		void databaseReadStatus(const QTime& started, int numReadGames, qint64 numReadBytes);
 
 	private:
+		struct Chunk;
+		void readChunk(Chunk* chunk);
+
 		QString m_fileName;
+		bool m_indexPositions;
+		QAtomicInteger<int> m_readGames;
+		QAtomicInteger<qint64> m_readBytes;
 
 };
 
@@ -76,6 +76,13 @@ SettingsDialog::SettingsDialog(QWidget* parent)
 				      checked);
 	});
 
+	connect(ui->m_indexDatabasePositionsCheck, &QCheckBox::toggled,
+		[=](bool checked)
+	{
+		QSettings().setValue("games/index_database_positions",
+				      checked);
+	});
+
 	connect(ui->m_moveAnimationSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
 		this, [=](int value)
 	{
@@ -238,6 +245,8 @@ void SettingsDialog::readSettings()
 	s.beginGroup("games");
 	ui->m_humanCanPlayAfterTimeoutCheck
 		->setChecked(s.value("human_can_play_after_timeout", true).toBool());
+	ui->m_indexDatabasePositionsCheck
+		->setChecked(s.value("index_database_positions", false).toBool());
 	ui->m_defaultPgnOutFileEdit
 		->setText(s.value("default_pgn_output_file").toString());
 	s.endGroup();
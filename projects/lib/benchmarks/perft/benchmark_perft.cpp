@@ -0,0 +1,157 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Runs perft for every registered variant and prints the results
+ * as CSV: variant,position,depth,nodes,msecs,nps
+ *
+ * Usage: benchmark_perft [-depth N] [variant...]
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QMap>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+
+namespace {
+
+struct Position
+{
+	QString name;
+	QString fen;
+};
+
+QMap<QString, QList<Position>> trickyPositions()
+{
+	QMap<QString, QList<Position>> positions;
+
+	positions["standard"] = {
+		{ "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" },
+		{ "endgame", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1" },
+		{ "promotions", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1" },
+		{ "discovered", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8" }
+	};
+	positions["fischerandom"] = {
+		{ "castling", "Q3B1kr/p5p1/1p3p1p/2p2P2/2br1N1P/8/P5P1/7K b k - 1 34" }
+	};
+	positions["crazyhouse"] = {
+		{ "drops", "r1b2rk1/pppp1ppp/2n5/4p3/1bB1P3/2N2N2/PPPP1qPP/R1B1K2R[QNn] w KQ - 0 8" }
+	};
+
+	return positions;
+}
+
+quint64 perft(Chess::Board* board, int depth)
+{
+	const auto moves = board->legalMoves();
+	if (depth <= 1)
+		return moves.size();
+
+	quint64 nodeCount = 0;
+	for (const auto& move : moves)
+	{
+		board->makeMove(move);
+		nodeCount += perft(board, depth - 1);
+		board->undoMove();
+	}
+
+	return nodeCount;
+}
+
+void runPerft(QTextStream& out,
+	      Chess::Board* board,
+	      const QString& name,
+	      const QString& fen,
+	      int depth)
+{
+	if (!board->setFenString(fen))
+	{
+		qWarning("Invalid FEN for %s: %s",
+			 qUtf8Printable(board->variant()),
+			 qUtf8Printable(fen));
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	quint64 nodes = perft(board, depth);
+	qint64 nsecs = qMax(timer.nsecsElapsed(), Q_INT64_C(1));
+
+	out << board->variant() << ','
+	    << name << ','
+	    << depth << ','
+	    << nodes << ','
+	    << QString::number(nsecs / 1.0e6, 'f', 3) << ','
+	    << qRound64(nodes * 1.0e9 / nsecs) << Qt::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	int depth = 3;
+	QStringList variants;
+	QStringList args = app.arguments();
+	args.removeFirst();
+
+	for (int i = 0; i < args.size(); i++)
+	{
+		if (args.at(i) == "-depth" && i + 1 < args.size())
+		{
+			bool ok = false;
+			depth = args.at(++i).toInt(&ok);
+			if (!ok || depth < 1)
+			{
+				qWarning("Invalid depth: %s", qUtf8Printable(args.at(i)));
+				return 1;
+			}
+		}
+		else
+			variants << args.at(i);
+	}
+	if (variants.isEmpty())
+		variants = Chess::BoardFactory::variants();
+
+	const auto positions = trickyPositions();
+	QTextStream out(stdout);
+	out << "variant,position,depth,nodes,msecs,nps" << Qt::endl;
+
+	for (const QString& variant : std::as_const(variants))
+	{
+		Chess::Board* board = Chess::BoardFactory::create(variant);
+		if (board == nullptr)
+		{
+			qWarning("Unknown variant: %s", qUtf8Printable(variant));
+			continue;
+		}
+
+		runPerft(out, board, "startpos", board->defaultFenString(), depth);
+		const auto extra = positions.value(variant);
+		for (const Position& pos : extra)
+			runPerft(out, board, pos.name, pos.fen, depth);
+
+		delete board;
+	}
+
+	return 0;
+}
@@ -1,6 +1,9 @@
 #include <QtTest/QTest>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
 #include <pgnstream.h>
 #include <pgngame.h>
+#include <pgngameentry.h>
 
 
 class tst_PgnGame: public QObject
@@ -10,11 +13,17 @@ class tst_PgnGame: public QObject
 	private slots:
 		void parser_data() const;
 		void parser();
+		void throughput_data() const;
+		void throughput();
+
+	private:
+		static QList<QByteArray> sampleGames();
+		static QByteArray largeInput(qint64 size);
 };
 
-void tst_PgnGame::parser_data() const
+QList<QByteArray> tst_PgnGame::sampleGames()
 {
-	QTest::addColumn<QByteArray>("pgn");
+	QList<QByteArray> games;
 	QByteArray pgn;
 
 	pgn = "[Event \"?\"]\n"
@@ -43,7 +52,7 @@ void tst_PgnGame::parser_data() const
 	      "85. Rg2 Rf6 86. Rh2 Rh6 87. Rg2 Kf1 88. Rg5 Rf6 89. Rc5 Rd2 90. Rc6 Rf4\n"
 	      "91. Rc1+ Kg2 92. Rbb1 Rf8 93. Ka5 Ra2+ 94. Kb6 Rf6+ 95. Kc5 Rf5+ 96. Kb6\n"
 	      "Re2 97. b5 Re6+ 98. Ka5 Rfe5 99. Ka4 Re4+ 1/2-1/2\n";
-	QTest::newRow("game1") << pgn;
+	games << pgn;
 
 	pgn = "[Event \"CCRL 40/40\"]\n"
 	      "[Site \"CCRL\"]\n"
@@ -83,7 +92,18 @@ void tst_PgnGame::parser_data() const
 	      "{-10.04/17 38s} Ke3 {+8.12/13 37s} 49. Ka3 {-11.44/18 38s} f4 {+9.40/14 37s}\n"
 	      "50. Rg5 {-12.37/18 38s} Rf1 {+9.91/13 37s} 51. Re5+ {-16.96/17 38s} Kd3\n"
 	      "{+12.91/14 37s 0-1 Adjudication} 0-1\n";
-	QTest::newRow("game2") << pgn;
+	games << pgn;
+
+	return games;
+}
+
+void tst_PgnGame::parser_data() const
+{
+	QTest::addColumn<QByteArray>("pgn");
+
+	const auto games = sampleGames();
+	QTest::newRow("game1") << games.at(0);
+	QTest::newRow("game2") << games.at(1);
 }
 
 void tst_PgnGame::parser()
@@ -99,5 +119,78 @@ void tst_PgnGame::parser()
 	}
 }
 
+QByteArray tst_PgnGame::largeInput(qint64 size)
+{
+	const auto games = sampleGames();
+	QByteArray data;
+	data.reserve(size);
+	while (data.size() < size)
+	{
+		for (const QByteArray& game : games)
+			data.append(game).append('\n');
+	}
+
+	return data;
+}
+
+void tst_PgnGame::throughput_data() const
+{
+	QTest::addColumn<QString>("fileName");
+	QTest::addColumn<bool>("readMoves");
+
+	// A large PGN file can be given in the PGN_BENCHMARK_FILE
+	// environment variable, eg. a tournament archive
+	const QString fileName = qEnvironmentVariable("PGN_BENCHMARK_FILE");
+	QTest::newRow("tags") << fileName << false;
+	QTest::newRow("moves") << fileName << true;
+}
+
+void tst_PgnGame::throughput()
+{
+	QFETCH(QString, fileName);
+	QFETCH(bool, readMoves);
+
+	QTemporaryFile tmpFile;
+	if (fileName.isEmpty())
+	{
+		// Repeat the games of the parser benchmark up to 64 MB
+		QVERIFY(tmpFile.open());
+		tmpFile.write(largeInput(64 * 1024 * 1024));
+		tmpFile.close();
+		fileName = tmpFile.fileName();
+	}
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+
+	PgnStream stream(&file);
+	PgnGameEntry entry;
+	PgnGame game;
+	int games = 0;
+	qint64 bytes = 0;
+	QElapsedTimer timer;
+
+	QBENCHMARK_ONCE
+	{
+		timer.start();
+		if (readMoves)
+		{
+			while (game.read(stream))
+				games++;
+		}
+		else
+		{
+			while (entry.read(stream))
+				games++;
+		}
+		bytes = stream.pos();
+	}
+
+	const double secs = qMax(timer.nsecsElapsed(), qint64(1)) / 1e9;
+	qInfo("%d games, %.1f MB in %.2f s: %.1f MB/s",
+	      games, bytes / 1e6, secs, bytes / 1e6 / secs);
+	QVERIFY(games > 0);
+}
+
 QTEST_MAIN(tst_PgnGame)
 #include "tst_pgngame.moc"
@@ -0,0 +1,65 @@
+#include <QtTest/QTest>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+
+class tst_Repetition: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void repeatCount_data() const;
+		void repeatCount();
+};
+
+void tst_Repetition::repeatCount_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<int>("plies");
+
+	QTest::newRow("standard 200") << "standard" << 200;
+	QTest::newRow("shogi 500") << "shogi" << 500;
+	QTest::newRow("shogi 2000") << "shogi" << 2000;
+	QTest::newRow("euroshogi 2000") << "euroshogi" << 2000;
+}
+
+void tst_Repetition::repeatCount()
+{
+	QFETCH(QString, variant);
+	QFETCH(int, plies);
+
+	Chess::Board* board = Chess::BoardFactory::create(variant);
+	QVERIFY(board != nullptr);
+	board->reset();
+
+	// Play a long deterministic game without adjudication
+	QVector<Chess::Move> game;
+	for (int i = 0; i < plies; i++)
+	{
+		const auto moves = board->legalMoves();
+		if (moves.isEmpty())
+			break;
+		const Chess::Move move = moves.at((i * 7) % moves.size());
+		board->makeMove(move);
+		game << move;
+	}
+	while (board->plyCount() > 0)
+		board->undoMove();
+
+	// Query repetitions after every ply like ChessGame does
+	QBENCHMARK
+	{
+		for (const Chess::Move& move : std::as_const(game))
+		{
+			board->makeMove(move);
+			board->repeatCount();
+		}
+		for (int i = 0; i < game.size(); i++)
+			board->undoMove();
+	}
+
+	delete board;
+}
+
+QTEST_MAIN(tst_Repetition)
+#include "tst_repetition.moc"
@@ -0,0 +1,543 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "binarygamelog.h"
+#include <QIODevice>
+#include <QRegularExpression>
+#include <QSet>
+#include "pgngame.h"
+#include "board/board.h"
+
+namespace {
+
+const quint32 s_magic = 0x43434247; // "CCBG"
+// Version 2 added the session records
+const quint16 s_version = 2;
+
+// Game flags
+const quint8 WideMoves = 1;
+const quint8 Annotations = 2;
+
+// Special score values of the move annotations
+const qint16 NoScore = -32768;
+const qint16 BookScore = -32767;
+const qint16 MateScore = 30000;
+const quint16 NoTime = 0xFFFF;
+
+// Tags that are stored in the game record itself
+const QSet<QString> s_gameTags = {
+	"White", "Black", "Result", "FEN", "SetUp"
+};
+
+const char* const s_results[] = { "*", "1-0", "0-1", "1/2-1/2" };
+
+void writeString(QDataStream& out, const QString& str)
+{
+	const QByteArray data(str.toUtf8().left(0xFFFF));
+	out << quint16(data.size());
+	out.writeRawData(data.constData(), data.size());
+}
+
+QString readString(QDataStream& in)
+{
+	quint16 size = 0;
+	in >> size;
+	QByteArray data(size, Qt::Uninitialized);
+	if (in.readRawData(data.data(), size) != size)
+		return QString();
+	return QString::fromUtf8(data);
+}
+
+// Move times are stored in milliseconds up to 32.767 seconds
+// and in tenths of a second after that
+quint16 encodeTime(int msecs)
+{
+	if (msecs < 0x8000)
+		return quint16(msecs);
+	return quint16(qMin(0x8000 + msecs / 100, int(NoTime) - 1));
+}
+
+int decodeTime(quint16 value)
+{
+	if (value < 0x8000)
+		return value;
+	return (value - 0x8000) * 100;
+}
+
+struct Annotation
+{
+	qint16 score;
+	quint8 depth;
+	quint16 time;
+};
+
+// Parses a move comment written by ChessGame, eg. "+0.35/12 1.5s"
+bool parseAnnotation(const QString& comment, Annotation* annotation)
+{
+	annotation->score = NoScore;
+	annotation->depth = 0;
+	annotation->time = NoTime;
+
+	if (comment.isEmpty())
+		return true;
+	if (comment == "book")
+	{
+		annotation->score = BookScore;
+		return true;
+	}
+
+	static const QRegularExpression re(
+		"^(?:([+-]?)(M?)(\\d+(?:\\.\\d+)?)?/(\\d+) )?(\\d+(?:\\.\\d+)?)s$");
+	// Secondary MultiPV lines aren't stored
+	const QRegularExpressionMatch match(re.match(comment.section("; ", 0, 0)));
+	if (!match.hasMatch())
+		return false;
+
+	if (match.capturedLength(3) > 0)
+	{
+		int score;
+		if (match.capturedLength(2) > 0)
+			score = MateScore + qMin(match.captured(3).toInt(), 2766);
+		else
+			score = qMin(qRound(match.captured(3).toDouble() * 100.0),
+				     MateScore - 1);
+		if (match.captured(1) == "-")
+			score = -score;
+		annotation->score = qint16(score);
+	}
+	if (match.capturedLength(4) > 0)
+		annotation->depth = quint8(qMin(match.captured(4).toInt(), 255));
+
+	const double secs = match.captured(5).toDouble();
+	annotation->time = encodeTime(qRound(secs * 1000.0));
+
+	return true;
+}
+
+// Rebuilds the comment in the same format as ChessGame
+QString annotationText(const Annotation& annotation)
+{
+	if (annotation.score == BookScore)
+		return "book";
+	if (annotation.time == NoTime)
+		return QString();
+
+	QString str;
+	const int score = annotation.score;
+	if (annotation.depth > 0 && score != NoScore)
+	{
+		const int absScore = qAbs(score);
+		if (score > 0)
+			str += "+";
+		if (absScore >= MateScore)
+		{
+			if (score < 0)
+				str += "-";
+			str += "M" + QString::number(absScore - MateScore);
+		}
+		else
+			str += QString::number(double(score) / 100.0, 'f', 2);
+	}
+	if (annotation.depth > 0)
+		str += "/" + QString::number(annotation.depth) + " ";
+
+	const int t = decodeTime(annotation.time);
+	if (t == 0)
+		return str + "0s";
+
+	int precision = 0;
+	if (t < 100)
+		precision = 3;
+	else if (t < 1000)
+		precision = 2;
+	else if (t < 10000)
+		precision = 1;
+	return str + QString::number(double(t / 1000.0), 'f', precision) + 's';
+}
+
+bool isNarrowSquare(const Chess::Square& square)
+{
+	return square.file() < 8 && square.rank() < 8;
+}
+
+// Drops are stored with the same source and target square
+quint32 encodeMove(const Chess::GenericMove& move, bool wide)
+{
+	const Chess::Square target(move.targetSquare());
+	const Chess::Square source(move.sourceSquare().isValid() ?
+				   move.sourceSquare() : target);
+	const quint32 promotion = quint32(move.promotion());
+
+	if (wide)
+		return (quint32(source.file()) << 28)
+		     | (quint32(source.rank()) << 24)
+		     | (quint32(target.file()) << 20)
+		     | (quint32(target.rank()) << 16)
+		     | (promotion << 8);
+
+	return (quint32(source.file()) << 13)
+	     | (quint32(source.rank()) << 10)
+	     | (quint32(target.file()) << 7)
+	     | (quint32(target.rank()) << 4)
+	     | promotion;
+}
+
+Chess::GenericMove decodeMove(quint32 value, bool wide)
+{
+	Chess::Square source;
+	Chess::Square target;
+	int promotion;
+
+	if (wide)
+	{
+		source = Chess::Square((value >> 28) & 0xF, (value >> 24) & 0xF);
+		target = Chess::Square((value >> 20) & 0xF, (value >> 16) & 0xF);
+		promotion = (value >> 8) & 0xFF;
+	}
+	else
+	{
+		source = Chess::Square((value >> 13) & 0x7, (value >> 10) & 0x7);
+		target = Chess::Square((value >> 7) & 0x7, (value >> 4) & 0x7);
+		promotion = value & 0xF;
+	}
+
+	if (source == target)
+		source = Chess::Square();
+	return Chess::GenericMove(source, target, promotion);
+}
+
+} // anonymous namespace
+
+BinaryGameLog::BinaryGameLog(QIODevice* device)
+	: m_stream(device),
+	  m_sessionStarted(false)
+{
+	Q_ASSERT(device != nullptr);
+}
+
+BinaryGameLog::Record BinaryGameLog::encode(const PgnGame& pgn,
+					     int whiteIndex,
+					     int blackIndex,
+					     int openingIndex,
+					     bool evaluations)
+{
+	Record record;
+	record.whiteIndex = whiteIndex;
+	record.blackIndex = blackIndex;
+	record.whiteName = pgn.playerName(Chess::Side::White);
+	record.blackName = pgn.playerName(Chess::Side::Black);
+
+	const auto tags = pgn.tags();
+	for (const auto& tag : tags)
+	{
+		if (!s_gameTags.contains(tag.first))
+			record.tags.append(tag);
+	}
+
+	const QVector<PgnGame::MoveData>& moves(pgn.moves());
+	const int plyCount = qMin(moves.size(), 0xFFFF);
+
+	// The result description is appended to the last move's comment
+	QString description;
+	QVector<Annotation> annotations(plyCount);
+	bool wide = false;
+	for (int i = 0; i < plyCount; i++)
+	{
+		const PgnGame::MoveData& md(moves.at(i));
+		const Chess::GenericMove& move(md.move);
+		if (!isNarrowSquare(move.targetSquare())
+		||  (move.sourceSquare().isValid()
+		     && !isNarrowSquare(move.sourceSquare()))
+		||  move.promotion() > 0xF)
+			wide = true;
+
+		if (parseAnnotation(md.comment, &annotations[i]))
+			continue;
+		if (i != plyCount - 1)
+			continue;
+
+		const int sep = md.comment.indexOf(", ");
+		if (sep != -1
+		&&  parseAnnotation(md.comment.left(sep), &annotations[i]))
+			description = md.comment.mid(sep + 2);
+		else
+			description = md.comment;
+	}
+
+	quint8 result = 0;
+	const QString resultStr(pgn.tagValue("Result"));
+	for (int i = 1; i < 4; i++)
+	{
+		if (resultStr == s_results[i])
+			result = quint8(i);
+	}
+
+	quint8 flags = 0;
+	if (wide)
+		flags |= WideMoves;
+	if (evaluations)
+		flags |= Annotations;
+
+	QDataStream out(&record.body, QIODevice::WriteOnly);
+	out << quint16(whiteIndex) << quint16(blackIndex)
+	    << qint32(openingIndex) << result << flags
+	    << quint8(pgn.startingSide() == Chess::Side::Black);
+	writeString(out, pgn.startingFenString());
+	writeString(out, description);
+
+	out << quint16(plyCount);
+	for (int i = 0; i < plyCount; i++)
+	{
+		const quint32 move = encodeMove(moves.at(i).move, wide);
+		if (wide)
+			out << move;
+		else
+			out << quint16(move);
+	}
+	if (evaluations)
+	{
+		for (const Annotation& annotation : std::as_const(annotations))
+			out << annotation.score << annotation.depth
+			    << annotation.time;
+	}
+
+	return record;
+}
+
+bool BinaryGameLog::writeHeader()
+{
+	m_stream << s_magic << s_version;
+	return m_stream.status() == QDataStream::Ok;
+}
+
+bool BinaryGameLog::writePlayer(int index, const QString& name)
+{
+	if (m_players.contains(index) && m_players.value(index) == name)
+		return true;
+
+	m_players[index] = name;
+	m_stream << quint8(PlayerRecord) << quint16(index);
+	writeString(m_stream, name);
+
+	return m_stream.status() == QDataStream::Ok;
+}
+
+bool BinaryGameLog::write(const Record& record)
+{
+	// The log may already contain players and tags from an earlier
+	// session, which this session doesn't know about
+	if (!m_sessionStarted)
+	{
+		m_stream << quint8(SessionRecord);
+		m_sessionStarted = true;
+	}
+
+	writePlayer(record.whiteIndex, record.whiteName);
+	writePlayer(record.blackIndex, record.blackName);
+
+	// Store only the tags that changed since the previous game
+	QMap<QString, QString> tags;
+	for (const auto& tag : record.tags)
+		tags.insert(tag.first, tag.second);
+
+	QList< QPair<QString, QString> > changes;
+	for (auto it = tags.constBegin(); it != tags.constEnd(); ++it)
+	{
+		if (m_tags.value(it.key()) != it.value())
+			changes.append(qMakePair(it.key(), it.value()));
+	}
+	for (auto it = m_tags.constBegin(); it != m_tags.constEnd(); ++it)
+	{
+		if (!tags.contains(it.key()))
+			changes.append(qMakePair(it.key(), QString()));
+	}
+
+	if (!changes.isEmpty())
+	{
+		m_tags = tags;
+		m_stream << quint8(TagRecord) << quint16(changes.size());
+		for (const auto& change : std::as_const(changes))
+		{
+			writeString(m_stream, change.first);
+			writeString(m_stream, change.second);
+		}
+	}
+
+	m_stream << quint8(GameRecord);
+	m_stream.writeRawData(record.body.constData(), record.body.size());
+
+	return m_stream.status() == QDataStream::Ok;
+}
+
+bool BinaryGameLog::readHeader()
+{
+	quint32 magic = 0;
+	quint16 version = 0;
+	m_stream >> magic >> version;
+
+	return m_stream.status() == QDataStream::Ok
+	    && magic == s_magic
+	    && version >= 1 && version <= s_version;
+}
+
+bool BinaryGameLog::atEnd() const
+{
+	return m_stream.atEnd();
+}
+
+bool BinaryGameLog::read(PgnGame* pgn, int* openingIndex)
+{
+	Q_ASSERT(pgn != nullptr);
+
+	while (!m_stream.atEnd())
+	{
+		quint8 type = 0;
+		m_stream >> type;
+
+		if (type == GameRecord)
+			return readGame(pgn, openingIndex);
+		if (type == SessionRecord)
+		{
+			m_players.clear();
+			m_tags.clear();
+		}
+		else if (type == PlayerRecord)
+		{
+			quint16 index = 0;
+			m_stream >> index;
+			m_players[index] = readString(m_stream);
+		}
+		else if (type == TagRecord)
+		{
+			quint16 count = 0;
+			m_stream >> count;
+			for (int i = 0; i < count; i++)
+			{
+				const QString tag(readString(m_stream));
+				const QString value(readString(m_stream));
+				if (value.isEmpty())
+					m_tags.remove(tag);
+				else
+					m_tags[tag] = value;
+			}
+		}
+		else
+		{
+			qWarning("Invalid game log record type: %d", type);
+			return false;
+		}
+
+		if (m_stream.status() != QDataStream::Ok)
+			return false;
+	}
+
+	return false;
+}
+
+bool BinaryGameLog::readGame(PgnGame* pgn, int* openingIndex)
+{
+	quint16 whiteIndex = 0;
+	quint16 blackIndex = 0;
+	qint32 opening = 0;
+	quint8 result = 0;
+	quint8 flags = 0;
+	quint8 startingSide = 0;
+	m_stream >> whiteIndex >> blackIndex >> opening
+		 >> result >> flags >> startingSide;
+	const QString fen(readString(m_stream));
+	const QString description(readString(m_stream));
+
+	quint16 plyCount = 0;
+	m_stream >> plyCount;
+
+	const bool wide = (flags & WideMoves);
+	QVector<Chess::GenericMove> moves(plyCount);
+	for (int i = 0; i < plyCount; i++)
+	{
+		quint32 value = 0;
+		if (wide)
+			m_stream >> value;
+		else
+		{
+			quint16 narrow = 0;
+			m_stream >> narrow;
+			value = narrow;
+		}
+		moves[i] = decodeMove(value, wide);
+	}
+
+	QVector<Annotation> annotations;
+	if (flags & Annotations)
+	{
+		annotations.resize(plyCount);
+		for (Annotation& annotation : annotations)
+			m_stream >> annotation.score >> annotation.depth
+				 >> annotation.time;
+	}
+
+	if (m_stream.status() != QDataStream::Ok || result > 3)
+		return false;
+	if (openingIndex != nullptr)
+		*openingIndex = opening;
+
+	pgn->clear();
+	for (auto it = m_tags.constBegin(); it != m_tags.constEnd(); ++it)
+		pgn->setTag(it.key(), it.value());
+	pgn->setPlayerName(Chess::Side::White, m_players.value(whiteIndex));
+	pgn->setPlayerName(Chess::Side::Black, m_players.value(blackIndex));
+	pgn->setTag("Result", s_results[result]);
+	pgn->setStartingFenString(startingSide ? Chess::Side::Black
+					       : Chess::Side::White, fen);
+
+	Chess::Board* board = pgn->createBoard();
+	if (board == nullptr)
+	{
+		qWarning("Invalid variant or starting position in game log");
+		return false;
+	}
+
+	bool ok = true;
+	for (int i = 0; i < plyCount; i++)
+	{
+		const Chess::Move move(board->moveFromGenericMove(moves.at(i)));
+		if (move.isNull() || !board->isLegalMove(move))
+		{
+			qWarning("Illegal move in game log");
+			ok = false;
+			break;
+		}
+
+		PgnGame::MoveData md;
+		md.key = board->key();
+		md.move = moves.at(i);
+		md.moveString = board->moveString(move,
+						  Chess::Board::StandardAlgebraic);
+		if (!annotations.isEmpty())
+			md.comment = annotationText(annotations.at(i));
+		pgn->addMove(md);
+
+		board->makeMove(move);
+	}
+	if (ok && !moves.isEmpty())
+		pgn->addEcoPosition(board->key());
+	delete board;
+
+	pgn->setResultDescription(description);
+
+	return ok;
+}
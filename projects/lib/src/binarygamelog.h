@@ -0,0 +1,149 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BINARYGAMELOG_H
+#define BINARYGAMELOG_H
+
+#include <QDataStream>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QByteArray>
+class QIODevice;
+class PgnGame;
+
+/*!
+ * \brief A compact binary log of chess games
+ *
+ * BinaryGameLog reads and writes an append-only sequence of game
+ * records. Compared to PGN a record is small and fast to parse:
+ * the moves are packed into 16-bit words (32-bit for large boards and
+ * drops), the players are referred to by their tournament index, and
+ * the tags that stay the same from game to game are stored only when
+ * they change. The engine evaluations and move times can be stored as
+ * quantized numbers alongside the moves.
+ *
+ * Each BinaryGameLog object that writes to a log starts a new session
+ * that doesn't inherit the players and tags of the earlier sessions,
+ * so runs can be appended to the same log.
+ *
+ * read() rebuilds each game as a PgnGame, so a log can be converted
+ * back to PGN. Move comments that weren't generated from an engine
+ * evaluation are not stored.
+ */
+class LIB_EXPORT BinaryGameLog
+{
+	public:
+		/*!
+		 * A game encoded for the log.
+		 *
+		 * A record is created with encode() and written with write().
+		 */
+		struct Record
+		{
+			/*! Tournament index of the white player. */
+			int whiteIndex;
+			/*! Tournament index of the black player. */
+			int blackIndex;
+			/*! Name of the white player. */
+			QString whiteName;
+			/*! Name of the black player. */
+			QString blackName;
+			/*! The game's tags that aren't part of \a body. */
+			QList< QPair<QString, QString> > tags;
+			/*! The encoded result, position and moves. */
+			QByteArray body;
+		};
+
+		/*!
+		 * Creates a new BinaryGameLog that operates on \a device.
+		 *
+		 * The device must be open for reading or for writing.
+		 */
+		explicit BinaryGameLog(QIODevice* device);
+
+		/*!
+		 * Encodes \a pgn as a log record.
+		 *
+		 * \a whiteIndex and \a blackIndex are the tournament indexes
+		 * of the players, and \a openingIndex is the index of the
+		 * game's opening in the opening suite, or -1 if the game
+		 * didn't start from a suite. If \a evaluations is true,
+		 * the evaluation and time of each move are stored.
+		 *
+		 * This function doesn't access any log, so it can be used
+		 * on any thread.
+		 */
+		static Record encode(const PgnGame& pgn,
+				     int whiteIndex,
+				     int blackIndex,
+				     int openingIndex,
+				     bool evaluations);
+
+		/*!
+		 * Writes the file header.
+		 *
+		 * The header must be written once at the beginning of a new
+		 * log. A log can be appended to without writing another
+		 * header.
+		 */
+		bool writeHeader();
+		/*!
+		 * Writes \a record to the log.
+		 *
+		 * Returns true if successful.
+		 */
+		bool write(const Record& record);
+
+		/*!
+		 * Reads and checks the file header.
+		 *
+		 * Returns false if the device doesn't contain a game log.
+		 */
+		bool readHeader();
+		/*!
+		 * Reads the next game into \a pgn.
+		 *
+		 * If \a openingIndex isn't null, it's set to the opening
+		 * index of the game. Returns false at the end of the log or
+		 * if the game can't be decoded.
+		 */
+		bool read(PgnGame* pgn, int* openingIndex = nullptr);
+		/*! Returns true if there are no more records to read. */
+		bool atEnd() const;
+
+	private:
+		enum RecordType
+		{
+			PlayerRecord = 1,
+			TagRecord,
+			GameRecord,
+			SessionRecord
+		};
+
+		bool writePlayer(int index, const QString& name);
+		bool readGame(PgnGame* pgn, int* openingIndex);
+
+		QDataStream m_stream;
+		QMap<int, QString> m_players;
+		QMap<QString, QString> m_tags;
+		bool m_sessionStarted;
+};
+
+#endif // BINARYGAMELOG_H
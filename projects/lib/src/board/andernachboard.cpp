@@ -89,6 +89,11 @@ void AndernachBoard::vUndoMove(const Move& move)
 	StandardBoard::vUndoMove(move);
 }
 
+bool AndernachBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 bool AndernachBoard::switchesSides(const Move& move) const
 {
 	return captureType(move) != Piece::NoPiece
@@ -66,6 +66,7 @@ class LIB_EXPORT AndernachBoard : public StandardBoard
 		virtual void vMakeMove(const Move& move,
 				       BoardTransition* transition);
 		virtual void vUndoMove(const Move &move);
+		virtual bool hasSimpleLegality() const;
 };
 
 
@@ -76,6 +76,11 @@ bool AntiBoard::inCheck(Side, int) const
 	return false;
 }
 
+bool AntiBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 bool AntiBoard::vIsLegalMove(const Move& move)
 {
 	if (!StandardBoard::vIsLegalMove(move))
@@ -68,6 +68,7 @@ class LIB_EXPORT AntiBoard : public StandardBoard
 						 int blackKings) const;
 		virtual bool vSetFenString(const QStringList& fen);
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 		virtual bool vIsLegalMove(const Move& move);
 		virtual void addPromotions(int sourceSquare,
 					   int targetSquare,
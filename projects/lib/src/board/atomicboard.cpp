@@ -65,6 +65,12 @@ void AtomicBoard::vInitialize()
 	WesternBoard::vInitialize();
 }
 
+bool AtomicBoard::hasSimpleLegality() const
+{
+	// Captures explode the pieces around the target square
+	return false;
+}
+
 bool AtomicBoard::vSetFenString(const QStringList& fen)
 {
 	m_history.clear();
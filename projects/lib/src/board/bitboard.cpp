@@ -0,0 +1,150 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bitboard.h"
+
+namespace {
+
+enum Direction
+{
+	North,
+	East,
+	NorthEast,
+	NorthWest,
+	South,
+	West,
+	SouthWest,
+	SouthEast,
+	DirectionCount
+};
+
+// Rays toward higher bit indexes come first
+const int FirstNegativeDirection = South;
+
+const int s_fileStep[DirectionCount] = { 0, 1, 1, -1, 0, -1, -1, 1 };
+const int s_rankStep[DirectionCount] = { 1, 0, 1, 1, -1, 0, -1, -1 };
+
+struct AttackTables
+{
+	AttackTables();
+
+	quint64 knight[64];
+	quint64 king[64];
+	quint64 ray[DirectionCount][64];
+};
+
+AttackTables::AttackTables()
+{
+	static const int knightSteps[8][2] = {
+		{ 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 },
+		{ -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 }
+	};
+
+	for (int sq = 0; sq < 64; sq++)
+	{
+		int file = sq % 8;
+		int rank = sq / 8;
+
+		knight[sq] = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			int f = file + knightSteps[i][0];
+			int r = rank + knightSteps[i][1];
+			if (f >= 0 && f < 8 && r >= 0 && r < 8)
+				knight[sq] |= Chess::Bitboard::bit(Chess::Bitboard::index(f, r));
+		}
+
+		king[sq] = 0;
+		for (int dir = 0; dir < DirectionCount; dir++)
+		{
+			ray[dir][sq] = 0;
+			int f = file + s_fileStep[dir];
+			int r = rank + s_rankStep[dir];
+			if (f >= 0 && f < 8 && r >= 0 && r < 8)
+				king[sq] |= Chess::Bitboard::bit(Chess::Bitboard::index(f, r));
+
+			while (f >= 0 && f < 8 && r >= 0 && r < 8)
+			{
+				ray[dir][sq] |= Chess::Bitboard::bit(Chess::Bitboard::index(f, r));
+				f += s_fileStep[dir];
+				r += s_rankStep[dir];
+			}
+		}
+	}
+}
+
+const AttackTables& tables()
+{
+	static const AttackTables s_tables;
+	return s_tables;
+}
+
+quint64 rayAttacks(int dir, int index, quint64 occupied)
+{
+	const AttackTables& t = tables();
+	quint64 attacks = t.ray[dir][index];
+	quint64 blockers = attacks & occupied;
+	if (blockers == 0)
+		return attacks;
+
+	int blocker;
+	if (dir < FirstNegativeDirection)
+		blocker = qCountTrailingZeroBits(blockers);
+	else
+		blocker = 63 - qCountLeadingZeroBits(blockers);
+
+	return attacks ^ t.ray[dir][blocker];
+}
+
+} // anonymous namespace
+
+namespace Chess {
+namespace Bitboard {
+
+quint64 knightAttacks(int index)
+{
+	Q_ASSERT(index >= 0 && index < 64);
+	return tables().knight[index];
+}
+
+quint64 kingAttacks(int index)
+{
+	Q_ASSERT(index >= 0 && index < 64);
+	return tables().king[index];
+}
+
+quint64 bishopAttacks(int index, quint64 occupied)
+{
+	Q_ASSERT(index >= 0 && index < 64);
+	return rayAttacks(NorthEast, index, occupied)
+	     | rayAttacks(NorthWest, index, occupied)
+	     | rayAttacks(SouthWest, index, occupied)
+	     | rayAttacks(SouthEast, index, occupied);
+}
+
+quint64 rookAttacks(int index, quint64 occupied)
+{
+	Q_ASSERT(index >= 0 && index < 64);
+	return rayAttacks(North, index, occupied)
+	     | rayAttacks(East, index, occupied)
+	     | rayAttacks(South, index, occupied)
+	     | rayAttacks(West, index, occupied);
+}
+
+} // namespace Bitboard
+} // namespace Chess
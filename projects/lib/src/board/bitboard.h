@@ -0,0 +1,82 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+namespace Chess {
+
+/*!
+ * \brief Attack sets for boards of up to 8x8 squares.
+ *
+ * A bitboard is a 64-bit set of squares where square (file, rank)
+ * maps to bit rank * 8 + file, so bit 0 is A1 and bit 63 is H8.
+ * Boards smaller than 8x8 use the same layout; the unused squares
+ * are never occupied, and because rays are straight lines they
+ * can't lead back onto the board.
+ *
+ * Sliding attacks are computed with precomputed rays and a bit scan
+ * for the first blocker, so no magic multipliers or PEXT are needed.
+ *
+ * \sa Board::hasBitboards()
+ */
+namespace Bitboard {
+
+/*! Returns the bit index of the square at \a file and \a rank. */
+inline int index(int file, int rank)
+{
+	return rank * 8 + file;
+}
+
+/*! Returns a bitboard with only bit \a index set. */
+inline quint64 bit(int index)
+{
+	return Q_UINT64_C(1) << index;
+}
+
+/*!
+ * Returns the index of the lowest set bit in \a bits.
+ * \note \a bits must not be empty.
+ */
+inline int firstIndex(quint64 bits)
+{
+	Q_ASSERT(bits != 0);
+	return qCountTrailingZeroBits(bits);
+}
+
+/*! Returns the squares a knight at \a index attacks. */
+LIB_EXPORT quint64 knightAttacks(int index);
+/*! Returns the squares a king at \a index attacks. */
+LIB_EXPORT quint64 kingAttacks(int index);
+/*!
+ * Returns the squares a bishop at \a index attacks when the
+ * occupied squares are \a occupied.
+ */
+LIB_EXPORT quint64 bishopAttacks(int index, quint64 occupied);
+/*!
+ * Returns the squares a rook at \a index attacks when the
+ * occupied squares are \a occupied.
+ */
+LIB_EXPORT quint64 rookAttacks(int index, quint64 occupied);
+
+} // namespace Bitboard
+} // namespace Chess
+#endif // BITBOARD_H
@@ -21,6 +21,7 @@
 #include <QStringView>
 #include <QRegularExpression>
 #include "zobrist.h"
+#include "bitboard.h"
 
 
 namespace Chess {
@@ -63,7 +64,11 @@ Board::Board(Zobrist* zobrist)
 	  m_maxPieceSymbolLength(1),
 	  m_key(0),
 	  m_zobrist(zobrist),
-	  m_sharedZobrist(zobrist)
+	  m_sharedZobrist(zobrist),
+	  m_hasBitboards(false),
+	  m_sideBits{ 0, 0 },
+	  m_occupancy(0),
+	  m_boardBits(0)
 {
 	Q_ASSERT(zobrist != nullptr);
 
@@ -89,6 +94,42 @@ bool Board::variantHasWallSquares() const
 	return false;
 }
 
+bool Board::hasBitboards() const
+{
+	return false;
+}
+
+void Board::updateBitboards()
+{
+	if (!m_hasBitboards)
+		return;
+
+	for (int side = Side::White; side <= Side::Black; side++)
+	{
+		for (int i = 0; i < m_pieceBits[side].size(); i++)
+			m_pieceBits[side][i] = 0;
+		m_sideBits[side] = 0;
+	}
+	m_occupancy = 0;
+
+	for (int i = 0; i < m_squares.size(); i++)
+	{
+		int index = m_bitIndex[i];
+		if (index == -1)
+			continue;
+
+		Piece piece = m_squares[i];
+		quint64 bit = Q_UINT64_C(1) << index;
+		if (piece.isValid())
+		{
+			m_pieceBits[piece.side()][piece.type()] |= bit;
+			m_sideBits[piece.side()] |= bit;
+		}
+		if (!piece.isEmpty())
+			m_occupancy |= bit;
+	}
+}
+
 QList<Piece> Board::reservePieceTypes() const
 {
 	return QList<Piece>();
@@ -121,6 +162,34 @@ void Board::initialize()
 	m_height = height();
 	for (int i = 0; i < (m_width + 2) * (m_height + 4); i++)
 		m_squares.append(Piece::WallPiece);
+
+	m_hasBitboards = hasBitboards() && m_width <= 8 && m_height <= 8;
+	if (m_hasBitboards)
+	{
+		m_bitIndex.resize(m_squares.size());
+		m_bitSquare.resize(64);
+		for (int i = 0; i < m_bitSquare.size(); i++)
+			m_bitSquare[i] = 0;
+		m_boardBits = 0;
+		for (int i = 0; i < m_squares.size(); i++)
+		{
+			Square sq(chessSquare(i));
+			if (!isValidSquare(sq))
+			{
+				m_bitIndex[i] = -1;
+				continue;
+			}
+
+			int index = Bitboard::index(sq.file(), sq.rank());
+			m_bitIndex[i] = index;
+			m_bitSquare[index] = i;
+			m_boardBits |= Bitboard::bit(index);
+		}
+		m_pieceBits[Side::White].resize(m_pieceData.size());
+		m_pieceBits[Side::Black].resize(m_pieceData.size());
+		updateBitboards();
+	}
+
 	vInitialize();
 
 	m_maxPieceSymbolLength = 1;
@@ -528,6 +597,7 @@ bool Board::setFenString(const QString& fen)
 	for (int i = 0; i < m_squares.size(); i++)
 		m_squares[i] = Piece::WallPiece;
 	m_key = 0;
+	updateBitboards();
 
 	// Get the board contents (squares)
 	int handPieceIndex = -1;
@@ -621,6 +691,9 @@ bool Board::setFenString(const QString& fen)
 	if (square != boardSize || square - rankEndSquare != m_width)
 		return false;
 
+	// Wall squares bypass setSquare()
+	updateBitboards();
+
 	// Hand pieces
 	m_reserve[Side::White].clear();
 	m_reserve[Side::Black].clear();
@@ -661,6 +734,8 @@ bool Board::setFenString(const QString& fen)
 		return false;
 
 	m_moveHistory.clear();
+	m_keyCount.clear();
+	m_oldKeyCounts.clear();
 	m_startingFen = fen;
 
 	// Let subclasses handle the rest of the FEN string
@@ -689,12 +764,26 @@ void Board::makeMove(const Move& move, BoardTransition* transition)
 	Q_ASSERT(!m_side.isNull());
 	Q_ASSERT(!move.isNull());
 
-	MoveData md = { move, m_key };
+	MoveData md = { move, m_key, false };
 
 	vMakeMove(move, transition);
 
 	xorKey(m_zobrist->side());
 	m_side = m_side.opposite();
+
+	// m_keyCount counts the positions since the last irreversible
+	// move, because the earlier ones can't be reached again. In drop
+	// variants captured pieces can return to the board, so their
+	// window never starts over.
+	if (reversibleMoveCount() == 0 && !variantHasDrops())
+	{
+		md.irreversible = true;
+		m_oldKeyCounts.append(m_keyCount);
+		m_keyCount.clear();
+	}
+	else
+		m_keyCount[md.key]++;
+
 	m_moveHistory << md;
 }
 
@@ -703,10 +792,21 @@ void Board::undoMove()
 	Q_ASSERT(!m_moveHistory.isEmpty());
 	Q_ASSERT(!m_side.isNull());
 
+	const MoveData& md = m_moveHistory.last();
 	m_side = m_side.opposite();
-	vUndoMove(m_moveHistory.last().move);
+	vUndoMove(md.move);
+	m_key = md.key;
+
+	if (md.irreversible)
+		m_keyCount = m_oldKeyCounts.takeLast();
+	else
+	{
+		auto it = m_keyCount.find(m_key);
+		Q_ASSERT(it != m_keyCount.end());
+		if (--it.value() == 0)
+			m_keyCount.erase(it);
+	}
 
-	m_key = m_moveHistory.last().key;
 	m_moveHistory.pop_back();
 }
 
@@ -787,6 +887,20 @@ void Board::generateSlidingMoves(int sourceSquare,
 	}
 }
 
+void Board::generateBitboardMoves(int sourceSquare,
+				  quint64 targets,
+				  QVarLengthArray<Move>& moves) const
+{
+	Q_ASSERT(m_hasBitboards);
+
+	targets &= emptyBitboard() | sideBitboard(m_side.opposite());
+	for (; targets != 0; targets &= targets - 1)
+	{
+		int index = Bitboard::firstIndex(targets);
+		moves.append(Move(sourceSquare, m_bitSquare[index]));
+	}
+}
+
 bool Board::moveExists(const Move& move) const
 {
 	Q_ASSERT(!move.isNull());
@@ -843,14 +957,7 @@ int Board::repeatCount() const
 	if (plyCount() < 4)
 		return 0;
 
-	int repeatCount = 0;
-	for (int i = plyCount() - 1; i >= 0; i--)
-	{
-		if (m_moveHistory.at(i).key == m_key)
-			repeatCount++;
-	}
-
-	return repeatCount;
+	return m_keyCount.value(m_key);
 }
 
 int Board::reversibleMoveCount() const
@@ -22,6 +22,7 @@
 #include <QString>
 #include <QVector>
 #include <QVarLengthArray>
+#include <QHash>
 #include <QSharedPointer>
 #include <QDebug>
 #include <QCoreApplication>
@@ -212,6 +213,13 @@ class LIB_EXPORT Board
 		 * The default implementation always returns -1.
 		 */
 		virtual int reversibleMoveCount() const;
+		/*!
+		 * Returns true if the board keeps bitboards of the piece
+		 * placement in addition to the square array.
+		 *
+		 * \sa hasBitboards()
+		 */
+		bool bitboardsEnabled() const;
 		/*!
 		 * Returns the number of reserve pieces of type \a piece.
 		 *
@@ -453,6 +461,17 @@ class LIB_EXPORT Board
 		void generateSlidingMoves(int sourceSquare,
 					  const QVarLengthArray<int>& offsets,
 					  QVarLengthArray<Move>& moves) const;
+		/*!
+		 * Generates moves from \a sourceSquare to the squares in the
+		 * bitboard \a targets that are empty or hold a piece of the
+		 * opponent.
+		 *
+		 * \note The board must keep bitboards.
+		 * \note The generated \a moves include captures
+		 */
+		void generateBitboardMoves(int sourceSquare,
+					   quint64 targets,
+					   QVarLengthArray<Move>& moves) const;
 		/*!
 		 * Returns true if the current position is a legal position.
 		 * If the position isn't legal it usually means that the last
@@ -516,6 +535,54 @@ class LIB_EXPORT Board
 		/*! Removes a piece of type \a piece from the reserve. */
 		void removeFromReserve(const Piece& piece);
 
+		/*!
+		 * Returns true if the board should keep bitboards of the
+		 * piece placement in addition to the square array.
+		 *
+		 * Bitboards are only kept for boards that have at most 8x8
+		 * squares, and they're updated by setSquare().
+		 * The default value is false.
+		 * \sa Bitboard
+		 */
+		virtual bool hasBitboards() const;
+		/*!
+		 * Returns the bitboard index of \a square, or -1 if the
+		 * board doesn't keep bitboards or \a square is not on the board.
+		 */
+		int bitIndex(int square) const;
+		/*!
+		 * Returns the square index of the bitboard index \a index.
+		 * \note The board must keep bitboards.
+		 */
+		int bitSquare(int index) const;
+		/*!
+		 * Returns the bitboard of the squares containing \a piece.
+		 * \note The board must keep bitboards.
+		 */
+		quint64 pieceBitboard(const Piece& piece) const;
+		/*!
+		 * Returns the bitboard of all occupied squares, including
+		 * wall squares inside the board.
+		 * \note The board must keep bitboards.
+		 */
+		quint64 occupancyBitboard() const;
+		/*!
+		 * Returns the bitboard of the squares containing pieces
+		 * of \a side.
+		 * \note The board must keep bitboards.
+		 */
+		quint64 sideBitboard(Side side) const;
+		/*!
+		 * Returns the bitboard of the empty squares on the board.
+		 * \note The board must keep bitboards.
+		 */
+		quint64 emptyBitboard() const;
+		/*!
+		 * Returns the number of piece types the variant has, including
+		 * the empty "NoPiece" type (type 0).
+		 */
+		int pieceTypeCount() const;
+
 	private:
 		struct PieceData
 		{
@@ -528,9 +595,12 @@ class LIB_EXPORT Board
 		{
 			Move move;
 			quint64 key;
+			bool irreversible;
 		};
 		friend LIB_EXPORT QDebug operator<<(QDebug dbg, const Board* board);
 
+		void updateBitboards();
+
 		bool m_initialized;
 		int m_width;
 		int m_height;
@@ -544,7 +614,16 @@ class LIB_EXPORT Board
 		QVarLengthArray<PieceData> m_pieceData;
 		QVarLengthArray<Piece> m_squares;
 		QVector<MoveData> m_moveHistory;
+		QHash<quint64, int> m_keyCount;
+		QVector<QHash<quint64, int>> m_oldKeyCounts;
 		QVector<int> m_reserve[2];
+		bool m_hasBitboards;
+		QVarLengthArray<int> m_bitIndex;
+		QVarLengthArray<int, 64> m_bitSquare;
+		QVarLengthArray<quint64, 16> m_pieceBits[2];
+		quint64 m_sideBits[2];
+		quint64 m_occupancy;
+		quint64 m_boardBits;
 };
 
 
@@ -593,9 +672,82 @@ inline void Board::setSquare(int square, Piece piece)
 	if (piece.isValid())
 		xorKey(m_zobrist->piece(piece, square));
 
+	if (m_hasBitboards && m_bitIndex[square] != -1)
+	{
+		quint64 bit = Q_UINT64_C(1) << m_bitIndex[square];
+
+		if (old.isValid())
+		{
+			m_pieceBits[old.side()][old.type()] &= ~bit;
+			m_sideBits[old.side()] &= ~bit;
+		}
+		if (piece.isValid())
+		{
+			m_pieceBits[piece.side()][piece.type()] |= bit;
+			m_sideBits[piece.side()] |= bit;
+		}
+		if (piece.isEmpty())
+			m_occupancy &= ~bit;
+		else
+			m_occupancy |= bit;
+	}
+
 	old = piece;
 }
 
+inline bool Board::bitboardsEnabled() const
+{
+	return m_hasBitboards;
+}
+
+inline int Board::bitIndex(int square) const
+{
+	if (!m_hasBitboards)
+		return -1;
+	return m_bitIndex[square];
+}
+
+inline int Board::bitSquare(int index) const
+{
+	Q_ASSERT(m_hasBitboards);
+	Q_ASSERT(index >= 0 && index < 64);
+
+	return m_bitSquare[index];
+}
+
+inline quint64 Board::pieceBitboard(const Piece& piece) const
+{
+	Q_ASSERT(m_hasBitboards);
+	Q_ASSERT(piece.isValid());
+
+	return m_pieceBits[piece.side()][piece.type()];
+}
+
+inline quint64 Board::occupancyBitboard() const
+{
+	Q_ASSERT(m_hasBitboards);
+	return m_occupancy;
+}
+
+inline quint64 Board::sideBitboard(Side side) const
+{
+	Q_ASSERT(m_hasBitboards);
+	Q_ASSERT(!side.isNull());
+
+	return m_sideBits[side];
+}
+
+inline quint64 Board::emptyBitboard() const
+{
+	Q_ASSERT(m_hasBitboards);
+	return m_boardBits & ~m_occupancy;
+}
+
+inline int Board::pieceTypeCount() const
+{
+	return m_pieceData.size();
+}
+
 inline int Board::plyCount() const
 {
 	return m_moveHistory.size();
@@ -54,4 +54,9 @@ bool ChecklessBoard::isLegalPosition()
 	return true;
 }
 
+bool ChecklessBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 } // namespace Chess
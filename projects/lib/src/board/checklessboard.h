@@ -48,6 +48,7 @@ class LIB_EXPORT ChecklessBoard : public WesternBoard
 
 	protected:
 		virtual bool isLegalPosition();
+		virtual bool hasSimpleLegality() const;
 };
 
 } // namespace Chess
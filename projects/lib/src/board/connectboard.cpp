@@ -192,6 +192,11 @@ bool ConnectBoard::isLegalPosition()
 	return true;
 }
 
+bool ConnectBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 bool ConnectBoard::pieceCountOk() const
 {
 	// Set the side balance counter one off for an odd number of squares
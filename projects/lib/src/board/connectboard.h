@@ -84,6 +84,7 @@ class LIB_EXPORT ConnectBoard : public WesternBoard
 				       Chess::BoardTransition * transition);
 		virtual void vUndoMove(const Chess::Move & move);
 		virtual bool isLegalPosition();
+		virtual bool hasSimpleLegality() const;
 
 	private:
 		bool pieceCountOk() const;
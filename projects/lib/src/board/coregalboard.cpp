@@ -60,4 +60,9 @@ bool CoRegalBoard::inCheck(Side side, int square) const
 	return false;
 }
 
+bool CoRegalBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 } // namespace Chess
@@ -51,6 +51,7 @@ class LIB_EXPORT CoRegalBoard : public WesternBoard
 
 	protected:
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 
 	private:
 		const QSet<int> m_royalPieceTypes;
@@ -64,6 +64,11 @@ bool ExtinctionBoard::inCheck(Side, int) const
 	return false;
 }
 
+bool ExtinctionBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 Piece ExtinctionBoard::extinctPiece(Side side) const
 {
 	for (const int type: m_pieceSet)
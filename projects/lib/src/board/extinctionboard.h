@@ -64,6 +64,7 @@ class LIB_EXPORT ExtinctionBoard : public StandardBoard
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 		virtual void addPromotions(int sourceSquare,
 					   int targetSquare,
 					   QVarLengthArray<Move>& moves) const;
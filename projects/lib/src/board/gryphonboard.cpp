@@ -137,6 +137,11 @@ bool GryphonBoard::isLegalPosition()
 	return true;
 }
 
+bool GryphonBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 void GryphonBoard::generateMovesForPiece(QVarLengthArray< Move >& moves,
 					 int pieceType,
 					 int square) const
@@ -63,6 +63,7 @@ class LIB_EXPORT GryphonBoard : public WesternBoard
 				       BoardTransition* transition);
 		virtual void vUndoMove(const Move& move);
 		virtual bool isLegalPosition();
+		virtual bool hasSimpleLegality() const;
 		virtual void generateMovesForPiece(QVarLengthArray< Move >& moves,
 						   int pieceType,
 						   int square) const;
@@ -64,6 +64,11 @@ bool JesonMorBoard::inCheck(Side side, int square) const
 	return WesternBoard::inCheck(side, square);
 }
 
+bool JesonMorBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 Result JesonMorBoard::result()
 {
 	QString str;
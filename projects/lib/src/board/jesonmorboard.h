@@ -51,6 +51,7 @@ class LIB_EXPORT JesonMorBoard : public WesternBoard
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 	private:
 		const int m_centralSquare;
 };
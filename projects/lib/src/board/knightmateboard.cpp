@@ -110,6 +110,11 @@ bool KnightMateBoard::inCheck(Side side, int square) const
 	return false;
 }
 
+bool KnightMateBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 Move KnightMateBoard::moveFromSanString(const QString& str)
 {
 	QString kingSymbol(pieceSymbol(King).toUpper());
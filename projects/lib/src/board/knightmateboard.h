@@ -54,6 +54,7 @@ class LIB_EXPORT KnightMateBoard : public WesternBoard
 						   int pieceType,
 						   int square) const;
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 		virtual void addPromotions(int sourceSquare,
 					   int targetSquare,
 					   QVarLengthArray<Move>& moves) const;
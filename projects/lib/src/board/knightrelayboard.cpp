@@ -45,6 +45,11 @@ bool KnightRelayBoard::pieceCanCapture(int pieceType) const
 	return pieceType != Knight;
 }
 
+bool KnightRelayBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 bool KnightRelayBoard::vIsLegalMove(const Move& move)
 {
 	// Knights cannot be captured
@@ -50,6 +50,7 @@ class LIB_EXPORT KnightRelayBoard : public StandardBoard
 		// Inherited from WesternBoard
 		virtual bool hasEnPassantCaptures() const;
 		virtual bool pieceCanCapture(int pieceType) const;
+		virtual bool hasSimpleLegality() const;
 		virtual void generateMovesForPiece(QVarLengthArray<Move>& moves,
 										   int pieceType,
 										   int square) const;
@@ -184,6 +184,11 @@ bool PlacementBoard::isLegalPosition()
 	return true;
 }
 
+bool PlacementBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 void PlacementBoard::setCastlingRights()
 {
 	for (const QChar c: "AHah")
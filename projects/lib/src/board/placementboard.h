@@ -74,6 +74,7 @@ class LIB_EXPORT PlacementBoard : public WesternBoard
 				       BoardTransition* transition);
 		virtual void vUndoMove(const Move& move);
 		virtual bool isLegalPosition();
+		virtual bool hasSimpleLegality() const;
 
 	private:
 		bool m_inSetUp;
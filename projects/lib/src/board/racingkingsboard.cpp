@@ -50,6 +50,11 @@ bool RacingKingsBoard::isLegalPosition()
 	return WesternBoard::isLegalPosition();
 }
 
+bool RacingKingsBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 /*! Returns true if the king of \a side is on the eighth rank */
 bool RacingKingsBoard::finished(Side side) const
 {
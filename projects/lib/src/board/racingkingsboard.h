@@ -50,6 +50,7 @@ class LIB_EXPORT RacingKingsBoard : public WesternBoard
 
 	protected:
 		virtual bool isLegalPosition();
+		virtual bool hasSimpleLegality() const;
 
 	private:
 		bool finished(Side side) const;
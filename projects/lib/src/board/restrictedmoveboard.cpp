@@ -69,4 +69,9 @@ bool RestrictedMoveBoard::inCheck(Side side, int square) const
 	return false;
 }
 
+bool RestrictedMoveBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 } // namespace Chess
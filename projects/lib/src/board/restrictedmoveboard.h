@@ -40,6 +40,7 @@ class LIB_EXPORT RestrictedMoveBoard : public WesternBoard
 		virtual Board* copy() const = 0;
 		virtual bool vIsLegalMove(const Move& move);
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 
 		/*!
 		 * Returns true if \a move fulfills the additional game rules.
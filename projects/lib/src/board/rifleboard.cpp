@@ -92,6 +92,11 @@ bool RifleBoard::inCheck(Side side, int square) const
 	return WesternBoard::inCheck(side, square);
 }
 
+bool RifleBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 void RifleBoard::addPromotions(int sourceSquare, int targetSquare,
 			       QVarLengthArray< Move >& moves) const
 {
@@ -65,6 +65,11 @@ bool SeirawanBoard::variantHasChanneling(Side side, int square) const
 	return  rank == baserank && !side.isNull();
 }
 
+bool SeirawanBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 QList<Piece> SeirawanBoard::reservePieceTypes() const
 {
 	QList<Piece> list;
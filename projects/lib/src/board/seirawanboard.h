@@ -66,6 +66,7 @@ class LIB_EXPORT SeirawanBoard : public WesternBoard
 		// Inherited from WesternBoard
 		virtual bool variantHasDrops() const;
 		virtual bool variantHasChanneling(Side side, int square) const;
+		virtual bool hasSimpleLegality() const;
 		virtual QList< Piece > reservePieceTypes() const;
 		virtual bool vIsLegalMove(const Chess::Move & move);
 		virtual void addPromotions(int sourceSquare,
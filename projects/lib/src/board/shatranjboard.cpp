@@ -118,6 +118,11 @@ bool ShatranjBoard::inCheck(Side side, int square) const
 	return WesternBoard::inCheck(side, square);
 }
 
+bool ShatranjBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 Result ShatranjBoard::result()
 {
 	Side side = sideToMove();
@@ -83,6 +83,7 @@ class LIB_EXPORT ShatranjBoard : public WesternBoard
 		virtual bool pawnHasDoubleStep() const;
 		virtual void vInitialize();
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 		virtual void generateMovesForPiece(QVarLengthArray<Move>& moves,
 						   int pieceType,
 						   int square) const;
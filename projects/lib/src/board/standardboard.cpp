@@ -1102,7 +1102,8 @@ Result StandardBoard::tablebaseResult(unsigned int* dtz) const
 					castling,
 					reversibleMoveCount(),
 					pieces,
-					dtz);
+					dtz,
+					key());
 }
 
 } // namespace Chess
@@ -17,7 +17,9 @@
 */
 
 #include "syzygytablebase.h"
+#include <QAtomicInteger>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QStringList>
 #include <tbprobe.h>
@@ -27,7 +29,23 @@ namespace {
 
 bool s_initialized = false, s_initOK = false, s_noRule50 = false;
 int s_pieces = INT_MAX;
-QMutex s_mutex;
+
+// Only the DTZ tables need to be locked: Fathom keeps them in a shared
+// most-recently-used list. WDL probes initialize each table file under
+// Fathom's own lock and are otherwise thread-safe. Probes with a
+// non-zero 50-move counter need the DTZ, so they are locked too.
+QMutex s_dtzMutex;
+
+// Probe result cache. Each entry holds the upper bits of a Zobrist key
+// and the WDL value + 1 in the lowest bits, so that an entry can be
+// read and written atomically without a lock.
+const quint64 s_cacheValueMask = 0x7;
+QAtomicInteger<quint64>* s_cache = nullptr;
+quint64 s_cacheMask = 0;
+
+QAtomicInteger<quint64> s_probeCount(0);
+QAtomicInteger<quint64> s_cacheHits(0);
+QAtomicInteger<quint64> s_probeTime(0);
 
 int tbSquare(const Chess::Square& square)
 {
@@ -36,6 +54,26 @@ int tbSquare(const Chess::Square& square)
 	return square.rank() * 8 + square.file();
 }
 
+unsigned cachedWdl(quint64 key)
+{
+	if (s_cache == nullptr || key == 0)
+		return TB_RESULT_FAILED;
+
+	quint64 entry = s_cache[(key >> 3) & s_cacheMask].loadRelaxed();
+	if (entry == 0 || (entry & ~s_cacheValueMask) != (key & ~s_cacheValueMask))
+		return TB_RESULT_FAILED;
+	return unsigned(entry & s_cacheValueMask) - 1;
+}
+
+void storeWdl(quint64 key, unsigned wdl)
+{
+	if (s_cache == nullptr || key == 0 || wdl == TB_RESULT_FAILED)
+		return;
+
+	quint64 entry = (key & ~s_cacheValueMask) | (wdl + 1);
+	s_cache[(key >> 3) & s_cacheMask].storeRelaxed(entry);
+}
+
 } // anonymous namespace
 
 bool SyzygyTablebase::initialize(const QString& path)
@@ -66,12 +104,42 @@ void SyzygyTablebase::setNoRule50()
 	s_noRule50 = true;
 }
 
+void SyzygyTablebase::setCacheSize(int entries)
+{
+	delete[] s_cache;
+	s_cache = nullptr;
+	s_cacheMask = 0;
+	if (entries <= 0)
+		return;
+
+	// Round down to a power of two
+	quint64 size = 1;
+	while (size * 2 <= quint64(entries))
+		size *= 2;
+
+	s_cache = new QAtomicInteger<quint64>[size];
+	for (quint64 i = 0; i < size; i++)
+		s_cache[i].storeRelaxed(0);
+	s_cacheMask = size - 1;
+}
+
+SyzygyTablebase::ProbeStats SyzygyTablebase::probeStats()
+{
+	ProbeStats stats;
+	stats.probes = s_probeCount.loadRelaxed();
+	stats.cacheHits = s_cacheHits.loadRelaxed();
+	stats.time = s_probeTime.loadRelaxed();
+
+	return stats;
+}
+
 Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 					   const Chess::Square& enpassantSq,
 					   Castling castling,
 					   int rule50,
 					   const PieceList& pieces,
-					   unsigned int* dtz)
+					   unsigned int* dtz,
+					   quint64 key)
 {
 	if (!s_initOK)
 		return Chess::Result();
@@ -80,6 +148,10 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 	if (pieces.size() > s_pieces)
 		return Chess::Result();
 
+	QElapsedTimer timer;
+	timer.start();
+	s_probeCount.fetchAndAddRelaxed(1);
+
 	bool wtm = (side == Chess::Side::White);
 	unsigned ep = (tbSquare(enpassantSq) < 0? 0: tbSquare(enpassantSq));
 	uint64_t white = 0, black = 0;
@@ -113,39 +185,60 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 		}
 	}
 
-	s_mutex.lock();
-	unsigned result = tb_probe_root(white, black, kings, queens, rooks,
-		bishops, knights, pawns, rule50, 0, ep, wtm, nullptr);
-	s_mutex.unlock();
+	// A WDL probe is enough if the DTZ isn't needed and the 50-move
+	// counter has just been reset
+	unsigned wdl = TB_RESULT_FAILED;
+	unsigned result = TB_RESULT_FAILED;
+	if (dtz == nullptr && rule50 == 0)
+	{
+		wdl = cachedWdl(key);
+		if (wdl != TB_RESULT_FAILED)
+			s_cacheHits.fetchAndAddRelaxed(1);
+		else
+		{
+			wdl = tb_probe_wdl(white, black, kings, queens, rooks,
+				bishops, knights, pawns, 0, 0, ep, wtm);
+			storeWdl(key, wdl);
+		}
+	}
+	else
+	{
+		s_dtzMutex.lock();
+		result = tb_probe_root(white, black, kings, queens, rooks,
+			bishops, knights, pawns, rule50, 0, ep, wtm, nullptr);
+		s_dtzMutex.unlock();
+
+		if (result == TB_RESULT_CHECKMATE)
+			wdl = TB_LOSS;
+		else if (result == TB_RESULT_STALEMATE)
+			wdl = TB_DRAW;
+		else if (result != TB_RESULT_FAILED)
+			wdl = TB_GET_WDL(result);
+	}
+	s_probeTime.fetchAndAddRelaxed(timer.nsecsElapsed());
 
 	Chess::Side winner(Chess::Side::NoSide); 
-	if (result == TB_RESULT_FAILED)
+	if (wdl == TB_RESULT_FAILED)
 		return Chess::Result();
-	if (result == TB_RESULT_CHECKMATE)
-		winner = (wtm? Chess::Side::Black: Chess::Side::White);
-	else if (result == TB_RESULT_STALEMATE)
-		winner = Chess::Side::NoSide;
-	else
+
+	switch (wdl)
 	{
-		switch (TB_GET_WDL(result))
-		{
-		case TB_BLESSED_LOSS:
-			if (!s_noRule50)
-				break;
-			// Fallthrough
-		case TB_LOSS:
-			winner = (wtm? Chess::Side::Black: Chess::Side::White);
-			break;
-		case TB_DRAW:
+	case TB_BLESSED_LOSS:
+		if (!s_noRule50)
 			break;
-		case TB_CURSED_WIN:
-			if (!s_noRule50)
-				break;
-			// Fallthrough
-		case TB_WIN:
-			winner = (wtm? Chess::Side::White: Chess::Side::Black);
+		// Fallthrough
+	case TB_LOSS:
+		winner = (wtm? Chess::Side::Black: Chess::Side::White);
+		break;
+	case TB_DRAW:
+		break;
+	case TB_CURSED_WIN:
+		if (!s_noRule50)
 			break;
-		}
+		// Fallthrough
+	case TB_WIN:
+		winner = (wtm? Chess::Side::White: Chess::Side::Black);
+		break;
 	}
 	if (dtz != nullptr)
 		*dtz = TB_GET_DTZ(result);
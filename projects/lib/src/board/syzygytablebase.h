@@ -36,6 +36,13 @@
  * positions. The Syzygy tablebases take the 50-move-rule into account.
  * Syzygy tablebases can only be used in standard chess and Fischer
  * Random chess.
+ *
+ * Probing is thread-safe, but only some probes run concurrently.
+ * A probe without a \a dtz pointer in a position where the 50-move
+ * counter is zero needs only the win/draw/loss tables and takes no
+ * lock. All other probes, ie. probes that need the distance to zero
+ * and probes with a non-zero 50-move counter, go through a single
+ * global lock and are serialized.
  */
 class LIB_EXPORT SyzygyTablebase
 {
@@ -54,6 +61,17 @@ class LIB_EXPORT SyzygyTablebase
 		/*! Synonym for QList< QPair<Chess::Square, Chess::Piece> >. */
 		typedef QList< QPair<Chess::Square, Chess::Piece> > PieceList;
 
+		/*! Tablebase probe statistics. */
+		struct ProbeStats
+		{
+			/*! Number of probes. */
+			quint64 probes;
+			/*! Number of probes answered by the result cache. */
+			quint64 cacheHits;
+			/*! Total time spent probing, in nanoseconds. */
+			quint64 time;
+		};
+
 		/*!
 		 * Initializes the tablebases.
 		 *
@@ -77,6 +95,20 @@ class LIB_EXPORT SyzygyTablebase
 		 * Disable the 50 move rule from consideration.
 		 */
 		static void setNoRule50();
+		/*!
+		 * Sets the size of the probe result cache to \a entries.
+		 * The size is rounded down to a power of two, and a size
+		 * of 0 (the default) disables the cache.
+		 *
+		 * The cache is shared by all threads. It stores the results
+		 * of probes that pass a Zobrist key to result().
+		 *
+		 * \note This function is not thread-safe; it must be
+		 * called before the tablebases are probed.
+		 */
+		static void setCacheSize(int entries);
+		/*! Returns the statistics of all probes made so far. */
+		static ProbeStats probeStats();
 		/*!
 		 * Returns the expected game result for the positions specified
 		 * by \a side, \a enpassantSq, \a castling and \a pieces.
@@ -88,6 +120,14 @@ class LIB_EXPORT SyzygyTablebase
 		 * If the position isn't found in the tablebases, a null result
 		 * is returned.
 		 *
+		 * \a key is the Zobrist key of the position. If it's not zero,
+		 * it is used to look up and store the result in the probe
+		 * result cache. Only probes that take no lock use the cache.
+		 *
+		 * \note Only a probe with a null \a dtz and a zero \a rule50
+		 * is lock-free. Other probes are serialized with a global
+		 * lock because Fathom keeps the DTZ tables in a shared list.
+		 *
 		 * \sa Chess::Board::tablebaseResult()
 		 */
 		static Chess::Result result(const Chess::Side& side,
@@ -95,7 +135,8 @@ class LIB_EXPORT SyzygyTablebase
 					    Castling castling,
 					    int rule50,
 					    const PieceList& pieces,
-					    unsigned int* dtz = nullptr);
+					    unsigned int* dtz = nullptr,
+					    quint64 key = 0);
 
 	private:
 		SyzygyTablebase();
@@ -51,6 +51,11 @@ bool ThreeKingsBoard::inCheck(Side, int) const
 	return false;
 }
 
+bool ThreeKingsBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 Result ThreeKingsBoard::result()
 {
 	if (kingCount(Side::White) > kingCount(Side::Black))
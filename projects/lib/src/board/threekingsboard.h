@@ -49,6 +49,7 @@ class LIB_EXPORT ThreeKingsBoard : public WesternBoard
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 	private:
 		int kingCount(Side side) const;
 };
@@ -89,6 +89,11 @@ bool TwoKingsEachBoard::inCheck(Side side, int square) const
 	return WesternBoard::inCheck(side, square);
 }
 
+bool TwoKingsEachBoard::hasSimpleLegality() const
+{
+	return false;
+}
+
 void TwoKingsEachBoard::generateMovesForPiece(QVarLengthArray< Move >& moves, int pieceType, int square) const
 {
 	if (pieceType != King)
@@ -54,6 +54,7 @@ class LIB_EXPORT TwoKingsEachBoard : public WesternBoard
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool inCheck(Side side, int square = 0) const;
+		virtual bool hasSimpleLegality() const;
 		virtual void generateMovesForPiece(QVarLengthArray< Move >& moves,
 						   int pieceType,
 						   int square) const;
@@ -19,6 +19,7 @@
 #include <QStringList>
 #include "westernzobrist.h"
 #include "boardtransition.h"
+#include "bitboard.h"
 
 
 namespace Chess {
@@ -36,6 +37,8 @@ WesternBoard::WesternBoard(WesternZobrist* zobrist)
 	  m_hasEnPassantCaptures(true),
 	  m_pawnAmbiguous(false),
 	  m_multiDigitNotation(false),
+	  m_hasSimpleLegality(true),
+	  m_legalityKey(0),
 	  m_zobrist(zobrist)
 {
 	setPieceType(Pawn, tr("pawn"), "P");
@@ -90,11 +93,28 @@ bool WesternBoard::variantHasChanneling(Side, int) const
 	return false;
 }
 
+bool WesternBoard::hasSimpleLegality() const
+{
+	return true;
+}
+
+bool WesternBoard::hasBitboards() const
+{
+	return true;
+}
+
 void WesternBoard::vInitialize()
 {
 	m_hasCastling = hasCastling();
 	m_pawnHasDoubleStep = pawnHasDoubleStep();
 	m_hasEnPassantCaptures = hasEnPassantCaptures();
+	m_hasSimpleLegality = hasSimpleLegality();
+
+	m_legalityKey = 0;
+	m_legality.checkers = 0;
+	m_legality.checkSquare = 0;
+	m_legality.checkOffset = 0;
+	m_legality.pins.clear();
 
 	m_arwidth = width() + 2;
 
@@ -133,6 +153,22 @@ void WesternBoard::vInitialize()
 	m_rookOffsets[2] = 1;
 	m_rookOffsets[3] = m_arwidth;
 
+	// Piece types that attack like a knight, bishop or rook
+	m_knightAttackers.clear();
+	m_bishopAttackers.clear();
+	m_rookAttackers.clear();
+	for (int type = 1; type < pieceTypeCount(); type++)
+	{
+		if (!pieceCanCapture(type))
+			continue;
+		if (pieceHasMovement(type, KnightMovement))
+			m_knightAttackers.append(type);
+		if (pieceHasMovement(type, BishopMovement))
+			m_bishopAttackers.append(type);
+		if (pieceHasMovement(type, RookMovement))
+			m_rookAttackers.append(type);
+	}
+
 	m_pawnAmbiguous = (pawnAmbiguity(FreeStep) > 1);
 	m_multiDigitNotation =  (height() > 9 && coordinateSystem() == NormalCoordinates)
 			     || (width() > 9 && coordinateSystem() == InvertedCoordinates);
@@ -1124,12 +1160,34 @@ void WesternBoard::generateMovesForPiece(QVarLengthArray<Move>& moves,
 	}
 	if (pieceType == King)
 	{
-		generateHoppingMoves(square, m_bishopOffsets, moves);
-		generateHoppingMoves(square, m_rookOffsets, moves);
+		if (bitboardsEnabled())
+			generateBitboardMoves(square,
+					      Bitboard::kingAttacks(bitIndex(square)),
+					      moves);
+		else
+		{
+			generateHoppingMoves(square, m_bishopOffsets, moves);
+			generateHoppingMoves(square, m_rookOffsets, moves);
+		}
 		generateCastlingMoves(moves);
 		return;
 	}
 
+	if (bitboardsEnabled())
+	{
+		int index = bitIndex(square);
+		quint64 occupied = occupancyBitboard();
+		quint64 targets = 0;
+		if (pieceHasMovement(pieceType, KnightMovement))
+			targets |= Bitboard::knightAttacks(index);
+		if (pieceHasMovement(pieceType, BishopMovement))
+			targets |= Bitboard::bishopAttacks(index, occupied);
+		if (pieceHasMovement(pieceType, RookMovement))
+			targets |= Bitboard::rookAttacks(index, occupied);
+		generateBitboardMoves(square, targets, moves);
+		return;
+	}
+
 	if (pieceHasMovement(pieceType, KnightMovement))
 		generateHoppingMoves(square, m_knightOffsets, moves);
 	if (pieceHasMovement(pieceType, BishopMovement))
@@ -1164,6 +1222,9 @@ bool WesternBoard::inCheck(Side side, int square) const
 		}
 	}
 
+	if (bitboardsEnabled())
+		return isAttackedByBitboards(opSide, square);
+
 	Piece opKing(opSide, King);
 	Piece piece;
 	
@@ -1226,6 +1287,39 @@ bool WesternBoard::inCheck(Side side, int square) const
 	return false;
 }
 
+quint64 WesternBoard::attackerBitboard(Side side,
+				       const QVarLengthArray<int, 8>& types) const
+{
+	quint64 pieces = 0;
+	for (int type: types)
+		pieces |= pieceBitboard(Piece(side, type));
+	return pieces;
+}
+
+bool WesternBoard::isAttackedByBitboards(Side side, int square) const
+{
+	int index = bitIndex(square);
+	Q_ASSERT(index != -1);
+
+	if (Bitboard::knightAttacks(index)
+	&   attackerBitboard(side, m_knightAttackers))
+		return true;
+
+	if (pieceCanCapture(King)
+	&&  (Bitboard::kingAttacks(index) & pieceBitboard(Piece(side, King))))
+		return true;
+
+	quint64 occupied = occupancyBitboard();
+	if (Bitboard::bishopAttacks(index, occupied)
+	&   attackerBitboard(side, m_bishopAttackers))
+		return true;
+	if (Bitboard::rookAttacks(index, occupied)
+	&   attackerBitboard(side, m_rookAttackers))
+		return true;
+
+	return false;
+}
+
 bool WesternBoard::isLegalPosition()
 {
 	Side side = sideToMove().opposite();
@@ -1279,9 +1373,225 @@ bool WesternBoard::vIsLegalMove(const Move& move)
 			return false;
 	}
 
+	bool isLegal;
+	if (m_hasSimpleLegality && isSimpleLegalMove(move, &isLegal))
+		return isLegal;
+
 	return Board::vIsLegalMove(move);
 }
 
+void WesternBoard::addChecker(int square, int offset)
+{
+	m_legality.checkers++;
+	m_legality.checkSquare = square;
+	m_legality.checkOffset = offset;
+}
+
+void WesternBoard::scanLegalityRay(int kingSquare,
+				   int offset,
+				   unsigned movement)
+{
+	Side side = sideToMove();
+	Piece opKing(side.opposite(), King);
+	int targetSquare = kingSquare + offset;
+	int pinned = 0;
+	Piece piece;
+
+	if (pieceAt(targetSquare) == opKing && pieceCanCapture(King))
+	{
+		addChecker(targetSquare, 0);
+		return;
+	}
+
+	// Same walk as in inCheck(), except that the first piece of the
+	// moving side is skipped to find out whether it is pinned.
+	while (!(piece = pieceAt(targetSquare)).isWall())
+	{
+		if (piece.isEmpty())
+		{
+			targetSquare += offset;
+			continue;
+		}
+		if (piece.side() == side)
+		{
+			if (pinned != 0)
+				return;
+			pinned = targetSquare;
+			targetSquare += offset;
+			continue;
+		}
+
+		if (pieceHasMovement(piece.type(), movement)
+		&&  pieceCanCapture(piece.type()))
+		{
+			if (pinned == 0)
+				addChecker(targetSquare, offset);
+			else
+			{
+				LegalityData::Pin pin = { pinned, offset, targetSquare };
+				m_legality.pins.append(pin);
+			}
+		}
+		return;
+	}
+}
+
+void WesternBoard::updateLegalityData()
+{
+	m_legalityKey = key();
+	m_legality.checkers = 0;
+	m_legality.checkSquare = 0;
+	m_legality.checkOffset = 0;
+	m_legality.pins.clear();
+
+	Side side = sideToMove();
+	Side opSide = side.opposite();
+	int square = m_kingSquare[side];
+	if (square == 0)
+		return;
+
+	// Pawn checks
+	if (pieceCanCapture(Pawn))
+	{
+		int sign = (side == Side::White) ? 1 : -1;
+		for (const PawnStep& pStep: m_pawnSteps)
+		{
+			if (pStep.type != CaptureStep)
+				continue;
+
+			int fromSquare = square - pawnPushOffset(pStep, -sign);
+			if (pieceAt(fromSquare) == Piece(opSide, Pawn))
+				addChecker(fromSquare, 0);
+		}
+	}
+
+	if (bitboardsEnabled())
+	{
+		updateLegalityDataByBitboards(square);
+		return;
+	}
+
+	// Knight, archbishop, chancellor checks
+	for (int i = 0; i < m_knightOffsets.size(); i++)
+	{
+		int fromSquare = square + m_knightOffsets[i];
+		Piece piece = pieceAt(fromSquare);
+		if (piece.side() == opSide
+		&&  pieceHasMovement(piece.type(), KnightMovement)
+		&&  pieceCanCapture(piece.type()))
+			addChecker(fromSquare, 0);
+	}
+
+	// Sliding checks and pins
+	for (int i = 0; i < m_bishopOffsets.size(); i++)
+		scanLegalityRay(square, m_bishopOffsets[i], BishopMovement);
+	for (int i = 0; i < m_rookOffsets.size(); i++)
+		scanLegalityRay(square, m_rookOffsets[i], RookMovement);
+}
+
+void WesternBoard::updateLegalityDataByBitboards(int kingSquare)
+{
+	Side opSide = sideToMove().opposite();
+	int index = bitIndex(kingSquare);
+
+	quint64 checkers = Bitboard::knightAttacks(index)
+			 & attackerBitboard(opSide, m_knightAttackers);
+	for (; checkers != 0; checkers &= checkers - 1)
+		addChecker(bitSquare(Bitboard::firstIndex(checkers)), 0);
+
+	// Only the rays that reach a slider of the opponent through any
+	// number of pieces can hold a check or a pin. An adjacent king
+	// that can capture is found by the same ray walk.
+	quint64 king = 0;
+	if (pieceCanCapture(King))
+		king = pieceBitboard(Piece(opSide, King));
+
+	if (Bitboard::bishopAttacks(index, 0)
+	&   (attackerBitboard(opSide, m_bishopAttackers) | king))
+	{
+		for (int i = 0; i < m_bishopOffsets.size(); i++)
+			scanLegalityRay(kingSquare, m_bishopOffsets[i],
+					BishopMovement);
+	}
+	if (Bitboard::rookAttacks(index, 0)
+	&   (attackerBitboard(opSide, m_rookAttackers) | king))
+	{
+		for (int i = 0; i < m_rookOffsets.size(); i++)
+			scanLegalityRay(kingSquare, m_rookOffsets[i],
+					RookMovement);
+	}
+}
+
+bool WesternBoard::isOnRay(int square, int offset, int end, int target) const
+{
+	for (int i = square + offset; ; i += offset)
+	{
+		if (i == target)
+			return true;
+		if (i == end)
+			return false;
+	}
+}
+
+bool WesternBoard::isSimpleLegalMove(const Move& move, bool* isLegal)
+{
+	Q_ASSERT(isLegal != nullptr);
+
+	Side side(sideToMove());
+	int source = move.sourceSquare();
+	int target = move.targetSquare();
+	int kingSq = m_kingSquare[side];
+	Piece piece(pieceAt(source));
+
+	if (m_legalityKey != key())
+		updateLegalityData();
+
+	if (source != 0 && source == kingSq)
+	{
+		// Castling has to check the squares the king passes through
+		Piece pieceAtTarget(pieceAt(target));
+		if (pieceAtTarget.type() == Rook && pieceAtTarget.side() == side)
+			return false;
+
+		// Lift the king so that it doesn't block the rays
+		// through its source square.
+		setSquare(source, Piece::NoPiece);
+		*isLegal = !inCheck(side, target);
+		setSquare(source, piece);
+		return true;
+	}
+
+	// En-passant captures remove a piece from a third square
+	if (piece.type() == Pawn && target == m_enpassantSquare)
+		return false;
+
+	*isLegal = false;
+	if (m_legality.checkers > 1)
+		return true;
+
+	for (const LegalityData::Pin& pin: std::as_const(m_legality.pins))
+	{
+		if (pin.square != source)
+			continue;
+		if (!isOnRay(kingSq, pin.offset, pin.pinner, target))
+			return true;
+		break;
+	}
+
+	if (m_legality.checkers == 1)
+	{
+		int checkSq = m_legality.checkSquare;
+		int offset = m_legality.checkOffset;
+		if (offset == 0 && target != checkSq)
+			return true;
+		if (offset != 0 && !isOnRay(kingSq, offset, checkSq, target))
+			return true;
+	}
+
+	*isLegal = true;
+	return true;
+}
+
 void WesternBoard::addPromotions(int sourceSquare,
 				 int targetSquare,
 				 QVarLengthArray<Move>& moves) const
@@ -143,6 +143,22 @@ class LIB_EXPORT WesternBoard : public Board
 		 * \sa SeirawanBoard
 		 */
 		virtual bool variantHasChanneling(Side side, int square) const;
+		/*!
+		 * Returns true if a move is legal exactly when it doesn't
+		 * leave the moving side's king in check, and if a move only
+		 * affects its source and target squares (castling and
+		 * en-passant captures excepted).
+		 *
+		 * With such rules pins and checks are detected once per
+		 * position, and most moves are verified without having to
+		 * make them on the board. Variants that override inCheck()
+		 * or isLegalPosition(), or whose moves have side effects on
+		 * other squares, must return false.
+		 *
+		 * The default value is true.
+		 * \sa AtomicBoard
+		 */
+		virtual bool hasSimpleLegality() const;
 		/*!
 		 * Adds pawn promotions to a move list.
 		 *
@@ -204,6 +220,7 @@ class LIB_EXPORT WesternBoard : public Board
 		virtual QString vFenIncludeString(FenNotation notation) const;
 
 		// Inherited from Board
+		virtual bool hasBitboards() const;
 		virtual void vInitialize();
 		virtual QString vFenString(FenNotation notation) const;
 		virtual bool vSetFenString(const QStringList& fen);
@@ -244,6 +261,34 @@ class LIB_EXPORT WesternBoard : public Board
 			int reversibleMoveCount;
 		};
 
+		// Pins and checks against the king of the side to move
+		struct LegalityData
+		{
+			struct Pin
+			{
+				int square;
+				int offset;
+				int pinner;
+			};
+
+			int checkers;
+			int checkSquare;
+			int checkOffset;
+			QVarLengthArray<Pin, 8> pins;
+		};
+
+		void updateLegalityData();
+		void updateLegalityDataByBitboards(int kingSquare);
+		void scanLegalityRay(int kingSquare,
+				     int offset,
+				     unsigned movement);
+		void addChecker(int square, int offset);
+		bool isOnRay(int square, int offset, int end, int target) const;
+		bool isSimpleLegalMove(const Move& move, bool* isLegal);
+		bool isAttackedByBitboards(Side side, int square) const;
+		quint64 attackerBitboard(Side side,
+					 const QVarLengthArray<int, 8>& types) const;
+
 		void generateCastlingMoves(QVarLengthArray<Move>& moves) const;
 		void generatePawnMoves(int sourceSquare,
 				       QVarLengthArray<Move>& moves) const;
@@ -274,6 +319,12 @@ class LIB_EXPORT WesternBoard : public Board
 		bool m_hasEnPassantCaptures;
 		bool m_pawnAmbiguous;
 		bool m_multiDigitNotation;
+		bool m_hasSimpleLegality;
+		quint64 m_legalityKey;
+		LegalityData m_legality;
+		QVarLengthArray<int, 8> m_knightAttackers;
+		QVarLengthArray<int, 8> m_bishopAttackers;
+		QVarLengthArray<int, 8> m_rookAttackers;
 		QVector<MoveData> m_history;
 		CastlingRights m_castlingRights;
 		int m_castleTarget[2][2];
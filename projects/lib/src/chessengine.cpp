@@ -18,6 +18,7 @@
 
 #include "chessengine.h"
 #include <QIODevice>
+#include <QMetaMethod>
 #include <QTimer>
 #include <QtAlgorithms>
 #include "engineoption.h"
@@ -88,6 +89,7 @@ void ChessEngine::setDevice(QIODevice* device)
 
 	m_ioDevice = device;
 	m_ioDevice->setParent(this);
+	m_readBuffer.clear();
 
 	connect(m_ioDevice, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
 	connect(m_ioDevice, SIGNAL(readChannelFinished()), this, SLOT(onCrashed()));
@@ -428,33 +430,66 @@ void ChessEngine::write(const QString& data, WriteMode mode)
 	}
 
 	Q_ASSERT(m_ioDevice->isWritable());
-	emit debugMessage(QString(">%1(%2): %3")
-			  .arg(name())
-			  .arg(m_id)
-			  .arg(data));
+	if (hasDebugListeners())
+		emit debugMessage(QString(">%1(%2): %3")
+				  .arg(name(), QString::number(m_id), data));
 
 	if (m_ioDevice->write(data.toLatin1() + "\n") == -1)
 		qWarning("Writing to engine %s(%d) failed",
 			 qUtf8Printable(name()), m_id);
 }
 
+bool ChessEngine::hasDebugListeners() const
+{
+	static const QMetaMethod signal =
+		QMetaMethod::fromSignal(&ChessPlayer::debugMessage);
+	return isSignalConnected(signal);
+}
+
+void ChessEngine::decodeLine(const char* data, int size)
+{
+	// Engine output is almost always plain ASCII, which can be
+	// widened into the reused line buffer without allocating.
+	m_line.resize(size);
+	QChar* out = m_line.data();
+	for (int i = 0; i < size; i++)
+	{
+		uchar c = uchar(data[i]);
+		if (c >= 0x80)
+		{
+			m_line = QString::fromUtf8(data, size);
+			return;
+		}
+		out[i] = QLatin1Char(char(c));
+	}
+}
+
 void ChessEngine::onReadyRead()
 {
-	while (m_ioDevice->isReadable() && m_ioDevice->canReadLine())
+	if (!m_ioDevice->isReadable())
+		return;
+
+	// Read everything available at once and split the lines in place
+	m_readBuffer.append(m_ioDevice->readAll());
+
+	int start = 0;
+	int end;
+	while ((end = m_readBuffer.indexOf('\n', start)) != -1)
 	{
-		QString line = QString(m_ioDevice->readLine());
-		if (line.endsWith('\n'))
-			line.chop(1);
-		if (line.endsWith('\r'))
-			line.chop(1);
-		if (line.isEmpty())
+		const char* data = m_readBuffer.constData() + start;
+		int size = end - start;
+		start = end + 1;
+
+		if (size > 0 && data[size - 1] == '\r')
+			size--;
+		if (size == 0)
 			continue;
 
-		emit debugMessage(QString("<%1(%2): %3")
-				  .arg(name())
-				  .arg(m_id)
-				  .arg(line));
-		parseLine(line);
+		decodeLine(data, size);
+		if (hasDebugListeners())
+			emit debugMessage(QString("<%1(%2): %3")
+					  .arg(name(), QString::number(m_id), m_line));
+		parseLine(m_line);
 
 		if (m_idleTimer->isActive())
 		{
@@ -463,7 +498,13 @@ void ChessEngine::onReadyRead()
 			else
 				m_idleTimer->stop();
 		}
+
+		if (!m_ioDevice->isReadable())
+			break;
 	}
+
+	// Keep the unfinished last line for the next read
+	m_readBuffer.remove(0, start);
 }
 
 void ChessEngine::flushWriteBuffer()
@@ -123,6 +123,12 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		/*! Returns a list of supported chess variants. */
 		QStringList variants() const;
 
+		/*!
+		 * Returns true if the engine restarts between games; otherwise
+		 * returns false.
+		 */
+		virtual bool restartsBetweenGames() const;
+
 	public slots:
 		// Inherited from ChessPlayer
 		virtual void go();
@@ -197,11 +203,6 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		 * The default value is \a EngineConfiguration::RestartAuto.
 		 */
 		EngineConfiguration::RestartMode restartMode() const;
-		/*!
-		 * Returns true if the engine restarts between games; otherwise
-		 * returns false.
-		 */
-		virtual bool restartsBetweenGames() const;
 		/*!
 		 * Returns true if the engine is currently thinking on the
 		 * opponent's move; otherwise returns false.
@@ -285,6 +286,9 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 	private:
 		static int s_count;
 
+		bool hasDebugListeners() const;
+		void decodeLine(const char* data, int size);
+
 		int m_id;
 		State m_pingState;
 		bool m_pinging;
@@ -297,6 +301,8 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		QTimer* m_idleTimer;
 		QTimer* m_protocolStartTimer;
 		QIODevice *m_ioDevice;
+		QByteArray m_readBuffer;
+		QString m_line;
 		QStringList m_writeBuffer;
 		QStringList m_variants;
 		QList<EngineOption*> m_options;
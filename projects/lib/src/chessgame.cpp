@@ -23,37 +23,6 @@
 #include "openingbook.h"
 #include "timecontrol.h"
 
-namespace {
-
-QString evalString(const MoveEvaluation& eval)
-{
-	if (eval.isBookEval())
-		return "book";
-	if (eval.isEmpty())
-		return QString();
-
-	QString str = eval.scoreText();
-	if (eval.depth() > 0)
-		str += "/" + QString::number(eval.depth()) + " ";
-
-	int t = eval.time();
-	if (t == 0)
-		return str + "0s";
-
-	int precision = 0;
-	if (t < 100)
-		precision = 3;
-	else if (t < 1000)
-		precision = 2;
-	else if (t < 10000)
-		precision = 1;
-	str += QString::number(double(t / 1000.0), 'f', precision) + 's';
-
-	return str;
-}
-
-} // anonymous namespace
-
 ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 	: QObject(parent),
 	  m_board(board),
@@ -64,6 +33,7 @@ ChessGame::ChessGame(Chess::Board* board, PgnGame* pgn, QObject* parent)
 	  m_pgnInitialized(false),
 	  m_bookOwnership(false),
 	  m_boardShouldBeFlipped(false),
+	  m_lazySan(false),
 	  m_pgn(pgn)
 {
 	Q_ASSERT(pgn != nullptr);
@@ -176,6 +146,9 @@ void ChessGame::stop(bool emitMoveChanged)
 
 	initializePgn();
 	m_gameInProgress = false;
+	if (m_lazySan)
+		generateSanStrings();
+	m_pgn->addEcoPosition(m_board->key());
 	const QVector<PgnGame::MoveData>& moves(m_pgn->moves());
 	int plies = moves.size();
 
@@ -227,12 +200,50 @@ void ChessGame::addPgnMove(const Chess::Move& move, const QString& comment)
 	PgnGame::MoveData md;
 	md.key = m_board->key();
 	md.move = m_board->genericMove(move);
-	md.moveString = m_board->moveString(move, Chess::Board::StandardAlgebraic);
 	md.comment = comment;
 
+	// With lazy SAN the move strings and the opening are
+	// filled in by generateSanStrings() when the game ends
+	if (m_lazySan)
+	{
+		m_pgn->addMove(md, false);
+		return;
+	}
+
+	md.moveString = m_board->moveString(move, Chess::Board::StandardAlgebraic);
 	m_pgn->addMove(md);
 }
 
+void ChessGame::generateSanStrings()
+{
+	const int plies = m_pgn->moves().size();
+	if (plies == 0)
+		return;
+	if (plies > m_moves.size() || plies != m_board->plyCount())
+	{
+		qWarning("Cannot generate the SAN strings of a game with "
+			 "%d PGN moves, %d moves and %d board plies",
+			 plies, int(m_moves.size()), m_board->plyCount());
+		return;
+	}
+
+	// Replay the game once from the starting position
+	for (int i = 0; i < plies; i++)
+		m_board->undoMove();
+
+	for (int i = 0; i < plies; i++)
+	{
+		const Chess::Move& move = m_moves.at(i);
+		PgnGame::MoveData md(m_pgn->moves().at(i));
+
+		md.moveString = m_board->moveString(move, Chess::Board::StandardAlgebraic);
+		m_pgn->setMove(i, md);
+		m_board->makeMove(move);
+	}
+
+	m_pgn->updateEco();
+}
+
 void ChessGame::emitLastMove()
 {
 	int ply = m_moves.size() - 1;
@@ -263,10 +274,18 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 
 	m_scores[m_moves.size()] = sender->evaluation().score();
 	m_moves.append(move);
-	addPgnMove(move, evalString(sender->evaluation()));
+	addPgnMove(move, sender->evaluation().pgnComment());
 
-	// Get the result before sending the move to the opponent
+	ChessPlayer* player = playerToWait();
+	if (player->timeControl()->isHourglass()
+	&&  sender->timeControl()->isHourglass())
+		player->addTime(sender->timeControl()->lastMoveTime());
+
+	// The opponent needs the position before the move, and gets
+	// the move even if it ends the game
+	player->makeMove(move);
 	m_board->makeMove(move);
+
 	m_result = m_board->result();
 	if (m_result.isNone())
 	{
@@ -276,15 +295,6 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 		m_adjudicator.addEval(m_board, sender->evaluation());
 		m_result = m_adjudicator.result();
 	}
-	m_board->undoMove();
-
-	ChessPlayer* player = playerToWait();
-	if (player->timeControl()->isHourglass()
-	&&  sender->timeControl()->isHourglass())
-		player->addTime(sender->timeControl()->lastMoveTime());
-
-	player->makeMove(move);
-	m_board->makeMove(move);
 
 	if (m_result.isNone())
 	{
@@ -463,6 +473,35 @@ bool ChessGame::setMoves(const PgnGame& pgn)
 	return true;
 }
 
+bool ChessGame::setTrustedMoves(const PgnGame& pgn)
+{
+	// The moves were only validated for the variant of the game
+	if (pgn.variant() != m_board->variant())
+		return setMoves(pgn);
+
+	setStartingFen(pgn.startingFenString());
+	if (!resetBoard())
+		return false;
+	m_scores.clear();
+	m_moves.clear();
+
+	// The moves were validated when the opening was cached, so
+	// only the game result has to be checked
+	for (const PgnGame::MoveData& md : pgn.moves())
+	{
+		Chess::Move move(m_board->moveFromGenericMove(md.move));
+		Q_ASSERT(m_board->isLegalMove(move));
+
+		m_board->makeMove(move);
+		if (!m_board->result().isNone())
+			return true;
+
+		m_moves.append(move);
+	}
+
+	return true;
+}
+
 void ChessGame::setOpeningBook(const OpeningBook* book,
 			       Chess::Side side,
 			       int depth)
@@ -529,6 +568,12 @@ void ChessGame::setStartDelay(int time)
 	m_startDelay = time;
 }
 
+void ChessGame::setLazySan(bool enabled)
+{
+	Q_ASSERT(!m_gameInProgress);
+	m_lazySan = enabled;
+}
+
 void ChessGame::setBookOwnership(bool enabled)
 {
 	m_bookOwnership = enabled;
@@ -65,12 +65,14 @@ class LIB_EXPORT ChessGame : public QObject
 				    Chess::Side side = Chess::Side());
 		void setMoves(const QVector<Chess::Move>& moves);
 		bool setMoves(const PgnGame& pgn);
+		bool setTrustedMoves(const PgnGame& pgn);
 		void setOpeningBook(const OpeningBook* book,
 				    Chess::Side side = Chess::Side(),
 				    int depth = 1000);
 		void setAdjudicator(const GameAdjudicator& adjudicator);
 		void setStartDelay(int time);
 		void setBookOwnership(bool enabled);
+		void setLazySan(bool enabled);
 
 		void generateOpening();
 
@@ -120,6 +122,7 @@ class LIB_EXPORT ChessGame : public QObject
 		bool resetBoard();
 		void initializePgn();
 		void addPgnMove(const Chess::Move& move, const QString& comment);
+		void generateSanStrings();
 		void emitLastMove();
 		
 		Chess::Board* m_board;
@@ -134,6 +137,7 @@ class LIB_EXPORT ChessGame : public QObject
 		bool m_pgnInitialized;
 		bool m_bookOwnership;
 		bool m_boardShouldBeFlipped;
+		bool m_lazySan;
 		QString m_error;
 		QString m_startingFen;
 		Chess::Result m_result;
@@ -21,14 +21,25 @@
 #include <QFile>
 #include <QDataStream>
 #include <QMutex>
+#include <QHash>
 #include "pgngame.h"
 #include "pgnstream.h"
+#include "board/board.h"
+#include "board/boardfactory.h"
 
 namespace {
 
 QStringList s_openings;
 EcoNode* s_root = nullptr;
 
+struct EcoPosition
+{
+	const EcoNode* node;
+	int ply;
+};
+QHash<quint64, EcoPosition> s_positions;
+int s_maxPly = 0;
+
 class EcoDeleter
 {
 	public:
@@ -97,7 +108,13 @@ void EcoNode::initialize()
 		{
 			QDataStream in(&file);
 			in.setVersion(QDataStream::Qt_4_6);
-			in >> s_openings >> s_root;
+			EcoNode* root = nullptr;
+			in >> s_openings >> root;
+
+			// Publish the tree only after the position table
+			// is complete
+			initializePositions(root);
+			s_root = root;
 		}
 	}
 	mutex.unlock();
@@ -114,14 +131,14 @@ void EcoNode::initialize(PgnStream& in)
 		return;
 	}
 
-	s_root = new EcoNode;
+	EcoNode* root = new EcoNode;
 	EcoNode* current;
 	QMap<QString, int> tmpOpenings;
 
 	PgnGame game;
 	while (game.read(in, INT_MAX - 1, false))
 	{
-		current = s_root;
+		current = root;
 		for (const PgnGame::MoveData& move : game.moves())
 		{
 			QString san = move.moveString;
@@ -133,7 +150,7 @@ void EcoNode::initialize(PgnStream& in)
 			}
 			current = node;
 		}
-		if (current == s_root)
+		if (current == root)
 			continue;
 
 		current->m_ecoCode = ecoFromString(game.tagValue("ECO"));
@@ -153,6 +170,55 @@ void EcoNode::initialize(PgnStream& in)
 
 		current->m_variation = game.tagValue("Variation");
 	}
+
+	initializePositions(root);
+	s_root = root;
+}
+
+void EcoNode::initializePositions(const EcoNode* root)
+{
+	s_positions.clear();
+	s_maxPly = 0;
+	if (root == nullptr)
+		return;
+
+	Chess::Board* board = Chess::BoardFactory::create("standard");
+	Q_ASSERT(board != nullptr);
+	board->reset();
+
+	addPositions(root, board, 0);
+	delete board;
+}
+
+void EcoNode::addPositions(const EcoNode* node, Chess::Board* board, int ply)
+{
+	s_maxPly = qMax(s_maxPly, ply);
+
+	for (auto it = node->m_children.cbegin(); it != node->m_children.cend(); ++it)
+	{
+		const Chess::Move move(board->moveFromString(it.key()));
+		if (move.isNull())
+		{
+			qWarning("Illegal move in ECO tree: %s",
+				 qUtf8Printable(it.key()));
+			continue;
+		}
+
+		board->makeMove(move);
+		const EcoNode* child = it.value();
+		if (child->isLeaf())
+		{
+			// Prefer the most direct route to a transposed position
+			const quint64 key = board->key();
+			auto pos = s_positions.find(key);
+			if (pos == s_positions.end())
+				s_positions.insert(key, {child, ply + 1});
+			else if (ply + 1 < pos->ply)
+				*pos = {child, ply + 1};
+		}
+		addPositions(child, board, ply + 1);
+		board->undoMove();
+	}
 }
 
 const EcoNode* EcoNode::root()
@@ -183,6 +249,22 @@ const EcoNode* EcoNode::find(const QVector<PgnGame::MoveData>& moves)
 	return nullptr;
 }
 
+const EcoNode* EcoNode::findPosition(quint64 key)
+{
+	if (!s_root)
+		initialize();
+
+	const auto it = s_positions.constFind(key);
+	return it != s_positions.constEnd() ? it->node : nullptr;
+}
+
+int EcoNode::maxPly()
+{
+	if (!s_root)
+		initialize();
+	return s_maxPly;
+}
+
 void EcoNode::write(const QString& fileName)
 {
 	if (!s_root)
@@ -24,6 +24,7 @@
 #include "pgngame.h"
 class QDataStream;
 class PgnStream;
+namespace Chess { class Board; }
 
 /*!
  * \brief A node in the ECO tree (Encyclopaedia of Chess Openings)
@@ -37,6 +38,12 @@ class PgnStream;
  * to a PgnGame can be found by traversing the ECO tree as new moves are added
  * to the game, or by passing all the moves at once to the find() function.
  *
+ * The final positions of the openings are also kept in a hash table keyed
+ * by their Zobrist keys. findPosition() classifies a position with a single
+ * lookup, and it also finds openings that were reached by transposition.
+ * Several openings can share a position, so a game that plays the moves of
+ * an opening should still be classified by following the tree.
+ *
  * \note The Encyclopaedia of Chess Openings only applies to games of standard
  * chess that start from the default starting position.
  */
@@ -87,6 +94,20 @@ class LIB_EXPORT EcoNode
 		 * opening sequence in \a moves.
 		 */
 		static const EcoNode* find(const QVector<PgnGame::MoveData>& moves);
+		/*!
+		 * Returns the opening whose final position has the Zobrist key
+		 * \a key, or 0 if there's no such opening.
+		 *
+		 * If several openings lead to the same position, the one with
+		 * the shortest move sequence is returned.
+		 * initialize() is called first if the tree is uninitialized.
+		 */
+		static const EcoNode* findPosition(quint64 key);
+		/*!
+		 * Returns the number of plies (halfmoves) in the longest
+		 * opening of the ECO tree.
+		 */
+		static int maxPly();
 		/*! Writes the ECO tree in binary format to \a fileName. */
 		static void write(const QString& fileName);
 
@@ -96,6 +117,10 @@ class LIB_EXPORT EcoNode
 
 		EcoNode();
 		void addChild(const QString& sanMove, EcoNode* child);
+		static void initializePositions(const EcoNode* root);
+		static void addPositions(const EcoNode* node,
+					 Chess::Board* board,
+					 int ply);
 
 		qint16 m_ecoCode;
 		qint32 m_opening;
@@ -18,10 +18,14 @@
 
 #include "gamemanager.h"
 #include <QThread>
+#include <QAbstractEventDispatcher>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
 #include <algorithm>
 #include "playerbuilder.h"
 #include "chessgame.h"
 #include "chessplayer.h"
+#include "chessengine.h"
 
 class GameInitializer : public QObject
 {
@@ -29,13 +33,15 @@ class GameInitializer : public QObject
 
 	public:
 		GameInitializer(const PlayerBuilder* white,
-				const PlayerBuilder* black);
+				const PlayerBuilder* black,
+				QObject* receiver);
 		virtual ~GameInitializer();
 
 		const PlayerBuilder* whiteBuilder() const;
 		const PlayerBuilder* blackBuilder() const;
 		void swapPlayers();
 		void setGame(ChessGame* game);
+		void setSpareCount(int count);
 
 	public slots:
 		void initializeGame();
@@ -49,20 +55,31 @@ class GameInitializer : public QObject
 		void onPlayerQuit();
 
 	private:
+		ChessPlayer* createPlayer(int index, QString* error);
+		ChessPlayer* takeSpare(int index);
+		void addSpares(int index);
 		void deletePlayer(int index);
+		void deleteSpares();
 
 		int m_playerCount;
+		int m_spareCount;
 		bool m_finishing;
+		bool m_needsSpares[2];
 		const PlayerBuilder* m_builder[2];
 		ChessPlayer* m_player[2];
+		QList<ChessPlayer*> m_spares[2];
 		ChessGame* m_game;
+		QObject* m_receiver;
 };
 
 GameInitializer::GameInitializer(const PlayerBuilder* white,
-				 const PlayerBuilder* black)
+				 const PlayerBuilder* black,
+				 QObject* receiver)
 	: m_playerCount(0),
+	  m_spareCount(0),
 	  m_finishing(false),
-	  m_game(nullptr)
+	  m_game(nullptr),
+	  m_receiver(receiver)
 {
 	Q_ASSERT(white != nullptr);
 	Q_ASSERT(black != nullptr);
@@ -71,17 +88,23 @@ GameInitializer::GameInitializer(const PlayerBuilder* white,
 	m_builder[Chess::Side::Black] = black;
 	m_player[0] = nullptr;
 	m_player[1] = nullptr;
+	m_needsSpares[0] = false;
+	m_needsSpares[1] = false;
 }
 
 GameInitializer::~GameInitializer()
 {
 	for (int i = 0; i < 2; i++)
 	{
-		if (m_player[i] == nullptr)
-			continue;
+		QList<ChessPlayer*> players(m_spares[i]);
+		if (m_player[i] != nullptr)
+			players << m_player[i];
 
-		m_player[i]->disconnect();
-		m_player[i]->kill();
+		for (ChessPlayer* player : std::as_const(players))
+		{
+			player->disconnect();
+			player->kill();
+		}
 	}
 }
 
@@ -99,6 +122,8 @@ void GameInitializer::swapPlayers()
 {
 	std::swap(m_builder[0], m_builder[1]);
 	std::swap(m_player[0], m_player[1]);
+	std::swap(m_spares[0], m_spares[1]);
+	std::swap(m_needsSpares[0], m_needsSpares[1]);
 }
 
 void GameInitializer::setGame(ChessGame* game)
@@ -106,6 +131,53 @@ void GameInitializer::setGame(ChessGame* game)
 	m_game = game;
 }
 
+void GameInitializer::setSpareCount(int count)
+{
+	m_spareCount = count;
+}
+
+ChessPlayer* GameInitializer::createPlayer(int index, QString* error)
+{
+	return m_builder[index]->create(m_receiver,
+					SIGNAL(debugMessage(QString)),
+					this, error);
+}
+
+ChessPlayer* GameInitializer::takeSpare(int index)
+{
+	while (!m_spares[index].isEmpty())
+	{
+		ChessPlayer* spare = m_spares[index].takeFirst();
+		if (spare->state() != ChessPlayer::Disconnected)
+			return spare;
+		spare->deleteLater();
+	}
+
+	return nullptr;
+}
+
+void GameInitializer::addSpares(int index)
+{
+	// Spares are only needed for players that get replaced
+	if (!m_needsSpares[index])
+	{
+		auto engine = qobject_cast<ChessEngine*>(m_player[index]);
+		if (engine == nullptr || !engine->restartsBetweenGames())
+			return;
+		m_needsSpares[index] = true;
+	}
+
+	// The spares are started right away so that the handshake
+	// is done by the time they're needed.
+	while (m_spares[index].size() < m_spareCount)
+	{
+		ChessPlayer* spare = createPlayer(index, nullptr);
+		if (spare == nullptr)
+			break;
+		m_spares[index] << spare;
+	}
+}
+
 void GameInitializer::deletePlayer(int index)
 {
 	ChessPlayer* player = m_player[index];
@@ -123,6 +195,27 @@ void GameInitializer::deletePlayer(int index)
 	}
 }
 
+void GameInitializer::deleteSpares()
+{
+	for (int i = 0; i < 2; i++)
+	{
+		const auto spares = m_spares[i];
+		m_spares[i].clear();
+
+		for (ChessPlayer* spare : spares)
+		{
+			if (spare->state() == ChessPlayer::Disconnected)
+				spare->deleteLater();
+			else
+			{
+				connect(spare, SIGNAL(disconnected()),
+					spare, SLOT(deleteLater()));
+				spare->kill();
+			}
+		}
+	}
+}
+
 void GameInitializer::initializeGame()
 {
 	for (int i = 0; i < 2; i++)
@@ -133,20 +226,22 @@ void GameInitializer::initializeGame()
 		&&  m_player[i]->state() == ChessPlayer::Disconnected)
 		{
 			deletePlayer(i);
+			m_needsSpares[i] = true;
 		}
 
+		if (m_player[i] == nullptr)
+			m_player[i] = takeSpare(i);
 		if (m_player[i] == nullptr)
 		{
 			QString error;
-			m_player[i] = m_builder[i]->create(thread()->parent(),
-							   SIGNAL(debugMessage(QString)),
-							   this, &error);
+			m_player[i] = createPlayer(i, &error);
 			m_game->setError(error);
 
 			if (m_player[i] == nullptr)
 			{
 				m_playerCount = 0;
 				deletePlayer(!i);
+				deleteSpares();
 
 				emit gameInitialized(false);
 				return;
@@ -156,6 +251,9 @@ void GameInitializer::initializeGame()
 	}
 	m_playerCount = 2;
 
+	for (int i = 0; i < 2; i++)
+		addSpares(i);
+
 	emit gameInitialized(true);
 }
 
@@ -164,6 +262,7 @@ void GameInitializer::finish()
 	if (m_finishing)
 		return;
 	m_finishing = true;
+	deleteSpares();
 
 	if (m_playerCount <= 0)
 	{
@@ -190,17 +289,115 @@ void GameInitializer::onPlayerQuit()
 }
 
 
-class GameThread : public QThread
+class WorkerThread : public QThread
+{
+	Q_OBJECT
+
+	public:
+		WorkerThread(QObject* parent);
+
+		int load() const;
+		void addLoad(int delta);
+		void startWork();
+		qint64 busyTime() const;
+		qint64 upTime() const;
+
+	protected:
+		// Inherited from QThread
+		virtual void run();
+
+	private slots:
+		void onAwake();
+		void onAboutToBlock();
+
+	private:
+		int m_load;
+		qint64 m_awakeTime;
+		QElapsedTimer m_upTime;
+		QAtomicInteger<qint64> m_busyTime;
+};
+
+WorkerThread::WorkerThread(QObject* parent)
+	: QThread(parent),
+	  m_load(0),
+	  m_awakeTime(0),
+	  m_busyTime(0)
+{
+}
+
+int WorkerThread::load() const
+{
+	return m_load;
+}
+
+void WorkerThread::addLoad(int delta)
+{
+	m_load += delta;
+	Q_ASSERT(m_load >= 0);
+}
+
+void WorkerThread::startWork()
+{
+	if (isRunning())
+		return;
+
+	m_busyTime.storeRelaxed(0);
+	m_upTime.start();
+	start();
+}
+
+qint64 WorkerThread::busyTime() const
+{
+	return m_busyTime.loadRelaxed();
+}
+
+qint64 WorkerThread::upTime() const
+{
+	return m_upTime.isValid() ? m_upTime.nsecsElapsed() : 0;
+}
+
+void WorkerThread::run()
+{
+	// The event dispatcher tells when the thread wakes up to process
+	// events and when it goes back to sleep. The time in between is
+	// the time the thread is busy.
+	QAbstractEventDispatcher* dispatcher = eventDispatcher();
+	connect(dispatcher, SIGNAL(awake()),
+		this, SLOT(onAwake()), Qt::DirectConnection);
+	connect(dispatcher, SIGNAL(aboutToBlock()),
+		this, SLOT(onAboutToBlock()), Qt::DirectConnection);
+
+	m_awakeTime = m_upTime.nsecsElapsed();
+	exec();
+
+	dispatcher->disconnect(this);
+}
+
+void WorkerThread::onAwake()
+{
+	m_awakeTime = m_upTime.nsecsElapsed();
+}
+
+void WorkerThread::onAboutToBlock()
+{
+	m_busyTime.fetchAndAddRelaxed(m_upTime.nsecsElapsed() - m_awakeTime);
+}
+
+
+class GameThread : public QObject
 {
 	Q_OBJECT
 
 	public:
 		GameThread(const PlayerBuilder* white,
 			   const PlayerBuilder* black,
-			   QObject* parent);
+			   WorkerThread* worker,
+			   GameManager* parent);
 		virtual ~GameThread();
 
 		bool isReady() const;
+		bool isRunning() const;
+		QThread* workerThread() const;
 		void newGame(ChessGame* game);
 		void finish();
 		void finishAndDelete();
@@ -216,37 +413,63 @@ class GameThread : public QThread
 	signals:
 		void gameInitialized(bool success);
 		void ready();
+		void finished();
 
 	private slots:
 		void onGameDestroyed();
+		void onInitializerDestroyed();
+		void onThreadFinished();
 
 	private:
 		bool m_ready;
+		bool m_running;
 		GameManager::StartMode m_startMode;
 		GameManager::CleanupMode m_cleanupMode;
 		ChessGame* m_game;
 		GameInitializer* m_initializer;
+		QThread* m_thread;
+		WorkerThread* m_worker;
 };
 
 GameThread::GameThread(const PlayerBuilder* white,
 		       const PlayerBuilder* black,
-		       QObject* parent)
-	: QThread(parent),
+		       WorkerThread* worker,
+		       GameManager* parent)
+	: QObject(parent),
 	  m_ready(true),
+	  m_running(true),
 	  m_startMode(GameManager::StartImmediately),
 	  m_cleanupMode(GameManager::DeletePlayers),
 	  m_game(nullptr),
-	  m_initializer(new GameInitializer(white, black))
+	  m_initializer(new GameInitializer(white, black, parent)),
+	  m_thread(worker),
+	  m_worker(worker)
 {
+	// Without a shared worker thread the players get a thread
+	// of their own, which lives as long as they do.
+	if (m_thread == nullptr)
+	{
+		m_thread = new QThread(this);
+		connect(m_thread, SIGNAL(finished()),
+			this, SLOT(onThreadFinished()),
+			Qt::QueuedConnection);
+	}
+	else
+		m_worker->addLoad(1);
+
+	m_initializer->setSpareCount(parent->enginePoolSize());
 	connect(m_initializer, SIGNAL(gameInitialized(bool)),
 		this, SIGNAL(gameInitialized(bool)));
 	connect(m_initializer, SIGNAL(finished()),
 		m_initializer, SLOT(deleteLater()),
 		Qt::QueuedConnection);
 	connect(m_initializer, SIGNAL(destroyed()),
-		this, SLOT(quit()),
+		this, SLOT(onInitializerDestroyed()),
 		Qt::QueuedConnection);
-	m_initializer->moveToThread(this);
+	m_initializer->moveToThread(m_thread);
+
+	if (m_worker == nullptr)
+		m_thread->start();
 }
 
 GameThread::~GameThread()
@@ -258,6 +481,16 @@ bool GameThread::isReady() const
 	return m_ready;
 }
 
+bool GameThread::isRunning() const
+{
+	return m_running;
+}
+
+QThread* GameThread::workerThread() const
+{
+	return m_thread;
+}
+
 void GameThread::newGame(ChessGame* game)
 {
 	m_ready = false;
@@ -329,13 +562,36 @@ void GameThread::onGameDestroyed()
 	emit ready();
 }
 
+void GameThread::onInitializerDestroyed()
+{
+	// A shared worker thread keeps running for other games
+	if (m_worker == nullptr)
+		m_thread->quit();
+	else
+		onThreadFinished();
+}
+
+void GameThread::onThreadFinished()
+{
+	if (m_worker != nullptr)
+		m_worker->addLoad(-1);
+	m_running = false;
+	emit finished();
+}
+
 
 GameManager::GameManager(QObject* parent)
 	: QObject(parent),
 	  m_finishing(false),
 	  m_concurrency(1),
-	  m_activeQueuedGameCount(0)
+	  m_activeQueuedGameCount(0),
+	  m_enginePoolSize(0)
+{
+}
+
+GameManager::~GameManager()
 {
+	stopWorkerThreads();
 }
 
 QList<ChessGame*> GameManager::activeGames() const
@@ -353,6 +609,54 @@ void GameManager::setConcurrency(int concurrency)
 	m_concurrency = concurrency;
 }
 
+int GameManager::enginePoolSize() const
+{
+	return m_enginePoolSize;
+}
+
+void GameManager::setEnginePoolSize(int size)
+{
+	Q_ASSERT(size >= 0);
+	m_enginePoolSize = size;
+}
+
+int GameManager::threadPoolSize() const
+{
+	return m_workerThreads.size();
+}
+
+void GameManager::setThreadPoolSize(int size)
+{
+	Q_ASSERT(size >= 0);
+	if (!m_threads.isEmpty())
+	{
+		qWarning("Cannot resize the thread pool while games are running");
+		return;
+	}
+
+	stopWorkerThreads();
+	qDeleteAll(m_workerThreads);
+	m_workerThreads.clear();
+
+	for (int i = 0; i < size; i++)
+		m_workerThreads << new WorkerThread(this);
+}
+
+double GameManager::threadPoolUtilization() const
+{
+	qint64 busyTime = 0;
+	qint64 upTime = 0;
+	for (const WorkerThread* thread : m_workerThreads)
+	{
+		busyTime += thread->busyTime();
+		upTime += thread->upTime();
+	}
+
+	if (upTime <= 0)
+		return 0.0;
+	return qMin(1.0, double(busyTime) / double(upTime));
+}
+
 void GameManager::cleanupIdleThreads()
 {
 	QList<GameThread*>::iterator it = m_activeThreads.begin();
@@ -387,6 +691,7 @@ void GameManager::cleanup()
 
 	if (m_threads.isEmpty())
 	{
+		stopWorkerThreads();
 		emit finished();
 		return;
 	}
@@ -445,6 +750,7 @@ void GameManager::onThreadQuit()
 	if (m_threads.isEmpty())
 	{
 		m_finishing = false;
+		stopWorkerThreads();
 		emit finished();
 	}
 }
@@ -500,7 +806,7 @@ void GameManager::onGameInitialized(bool success)
 	if (gameThread->startMode() == Enqueue)
 		cleanupIdleThreads();
 
-	game->moveToThread(gameThread);
+	game->moveToThread(gameThread->workerThread());
 	connect(game, SIGNAL(started(ChessGame*)),
 		this, SIGNAL(gameStarted(ChessGame*)),
 		Qt::QueuedConnection);
@@ -528,7 +834,8 @@ GameThread* GameManager::getThread(const PlayerBuilder* white,
 			return thread;
 	}
 
-	GameThread* gameThread = new GameThread(white, black, this);
+	GameThread* gameThread = new GameThread(white, black,
+						getWorkerThread(), this);
 	m_threads << gameThread;
 	m_activeThreads << gameThread;
 	connect(gameThread, SIGNAL(ready()),
@@ -537,10 +844,34 @@ GameThread* GameManager::getThread(const PlayerBuilder* white,
 		this, SLOT(onGameInitialized(bool)),
 		Qt::QueuedConnection);
 
-	gameThread->start();
 	return gameThread;
 }
 
+WorkerThread* GameManager::getWorkerThread()
+{
+	if (m_workerThreads.isEmpty())
+		return nullptr;
+
+	WorkerThread* worker = m_workerThreads.first();
+	for (WorkerThread* thread : std::as_const(m_workerThreads))
+	{
+		if (thread->load() < worker->load())
+			worker = thread;
+	}
+
+	worker->startWork();
+	return worker;
+}
+
+void GameManager::stopWorkerThreads()
+{
+	for (WorkerThread* thread : std::as_const(m_workerThreads))
+	{
+		thread->quit();
+		thread->wait();
+	}
+}
+
 void GameManager::startGame(const GameEntry& entry)
 {
 	GameThread* gameThread = getThread(entry.white, entry.black);
@@ -26,6 +26,7 @@ class ChessGame;
 class ChessPlayer;
 class PlayerBuilder;
 class GameThread;
+class WorkerThread;
 
 
 /*!
@@ -35,6 +36,11 @@ class GameThread;
  * multiple games concurrently, and queue games to be
  * run when a game slot/thread is free.
  *
+ * By default each pair of players lives in its own thread. With
+ * a thread pool the games are instead shared by a fixed number of
+ * worker threads, which scales better when most of the games are
+ * just waiting for the engines to respond.
+ *
  * \sa ChessGame, PlayerBuilder
  */
 class LIB_EXPORT GameManager : public QObject
@@ -71,6 +77,8 @@ class LIB_EXPORT GameManager : public QObject
 
 		/*! Creates a new game manager. */
 		GameManager(QObject* parent = nullptr);
+		/*! Stops the worker threads of the thread pool. */
+		virtual ~GameManager();
 
 		/*!
 		 * Returns the list of active games.
@@ -98,6 +106,56 @@ class LIB_EXPORT GameManager : public QObject
 		 */
 		void setConcurrency(int concurrency);
 
+		/*!
+		 * Returns the number of spare engines kept ready for each
+		 * player of a pair.
+		 *
+		 * \sa setEnginePoolSize()
+		 */
+		int enginePoolSize() const;
+		/*!
+		 * Sets the number of spare engines per player to \a size.
+		 *
+		 * An engine that restarts between games, or that has
+		 * crashed once, gets \a size spare instances that are
+		 * started and initialized in the background. When the
+		 * engine has to be replaced, a spare is used instead of
+		 * waiting for a new engine to start up.
+		 *
+		 * The default value is 0 (no spare engines). The new size
+		 * affects pairs of players that are created afterwards.
+		 */
+		void setEnginePoolSize(int size);
+
+		/*!
+		 * Returns the number of worker threads shared by the games,
+		 * or 0 if each pair of players has its own thread.
+		 *
+		 * \sa setThreadPoolSize()
+		 */
+		int threadPoolSize() const;
+		/*!
+		 * Sets the number of shared worker threads to \a size.
+		 *
+		 * If \a size is 0 (the default), each pair of players gets
+		 * a dedicated thread. Otherwise the games and their players
+		 * are assigned to the least loaded of \a size threads. The
+		 * players are still reused for consecutive games of the
+		 * same pair.
+		 *
+		 * \note The pool size can't be changed while games are
+		 * running.
+		 */
+		void setThreadPoolSize(int size);
+		/*!
+		 * Returns the fraction of time (from 0 to 1) the worker
+		 * threads have spent processing events instead of waiting
+		 * for them, or 0 if the thread pool is not in use.
+		 *
+		 * \sa setThreadPoolSize()
+		 */
+		double threadPoolUtilization() const;
+
 		/*!
 		 * Cleans up and deletes all idle game threads
 		 *
@@ -200,6 +258,8 @@ class LIB_EXPORT GameManager : public QObject
 
 		GameThread* getThread(const PlayerBuilder* white,
 				      const PlayerBuilder* black);
+		WorkerThread* getWorkerThread();
+		void stopWorkerThreads();
 		void startGame(const GameEntry& entry);
 		void startQueuedGame();
 		void cleanup();
@@ -207,10 +267,12 @@ class LIB_EXPORT GameManager : public QObject
 		bool m_finishing;
 		int m_concurrency;
 		int m_activeQueuedGameCount;
+		int m_enginePoolSize;
 		QList< QPointer<GameThread> > m_threads;
 		QList<GameThread*> m_activeThreads;
 		QList<GameEntry> m_gameEntries;
 		QList<ChessGame*> m_activeGames;
+		QList<WorkerThread*> m_workerThreads;
 };
 
 #endif // GAMEMANAGER_H
@@ -0,0 +1,439 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gamewriter.h"
+#include <QTextStream>
+#include <QMutexLocker>
+
+namespace {
+
+// Size of the blocks that are written to the files at once
+const int s_blockSize = 64 * 1024;
+// Time after which buffered output is flushed when no more games arrive
+const unsigned long s_idleFlushTime = 1000;
+
+} // anonymous namespace
+
+class GameWriter::WriterThread : public QThread
+{
+	public:
+		explicit WriterThread(GameWriter* writer)
+			: m_writer(writer)
+		{
+		}
+
+	protected:
+		// Inherited from QThread
+		void run() override
+		{
+			m_writer->run();
+		}
+
+	private:
+		GameWriter* m_writer;
+};
+
+
+GameWriter::GameWriter()
+	: m_thread(new WriterThread(this)),
+	  m_addedTaskCount(0),
+	  m_flushTarget(0),
+	  m_flushedTaskCount(0),
+	  m_quit(false),
+	  m_error(false),
+	  m_pgnMode(PgnGame::Verbose),
+	  m_binaryEvaluations(false),
+	  m_savedGameCount(0),
+	  m_binaryRecordSize(0),
+	  m_binaryLog(nullptr),
+	  m_hasUnflushedOutput(false)
+{
+	m_binaryBuffer.open(QIODevice::WriteOnly);
+	m_thread->start(QThread::LowPriority);
+}
+
+GameWriter::~GameWriter()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		m_quit = true;
+		m_taskAdded.wakeOne();
+	}
+	m_thread->wait();
+	delete m_thread;
+	delete m_binaryLog;
+}
+
+void GameWriter::setPgnOutput(const QString& fileName,
+			      PgnGame::PgnMode mode)
+{
+	Task task;
+	task.type = Task::PgnOutput;
+	task.text = fileName;
+	task.mode = mode;
+	addTask(task);
+}
+
+void GameWriter::setEpdOutput(const QString& fileName)
+{
+	Task task;
+	task.type = Task::EpdOutput;
+	task.text = fileName;
+	addTask(task);
+}
+
+void GameWriter::setBinaryOutput(const QString& fileName, bool evaluations)
+{
+	Task task;
+	task.type = Task::BinaryOutput;
+	task.text = fileName;
+	task.evaluations = evaluations;
+	addTask(task);
+}
+
+void GameWriter::addGame(int gameNumber,
+			 const PgnGame& pgn,
+			 int whiteIndex,
+			 int blackIndex,
+			 int openingIndex,
+			 bool omit)
+{
+	Q_ASSERT(gameNumber > 0);
+
+	Task task;
+	task.type = Task::Game;
+	task.gameNumber = gameNumber;
+	task.whiteIndex = whiteIndex;
+	task.blackIndex = blackIndex;
+	task.openingIndex = openingIndex;
+	task.omit = omit;
+	if (!omit)
+		task.pgn = pgn;
+	addTask(task);
+}
+
+void GameWriter::addEpdPosition(const QString& fen)
+{
+	Task task;
+	task.type = Task::EpdPosition;
+	task.text = fen;
+	addTask(task);
+}
+
+void GameWriter::reset()
+{
+	Task task;
+	task.type = Task::Reset;
+	addTask(task);
+}
+
+void GameWriter::flush()
+{
+	QMutexLocker locker(&m_mutex);
+
+	const quint64 target = m_addedTaskCount;
+	if (m_flushedTaskCount >= target)
+		return;
+
+	m_flushTarget = qMax(m_flushTarget, target);
+	m_taskAdded.wakeOne();
+	while (m_flushedTaskCount < target)
+		m_tasksFlushed.wait(&m_mutex);
+}
+
+bool GameWriter::hasError() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_error;
+}
+
+void GameWriter::setError(bool error)
+{
+	QMutexLocker locker(&m_mutex);
+	m_error = error;
+}
+
+void GameWriter::addTask(const Task& task)
+{
+	QMutexLocker locker(&m_mutex);
+	m_tasks.append(task);
+	m_addedTaskCount++;
+	m_taskAdded.wakeOne();
+}
+
+void GameWriter::run()
+{
+	QVector<Task> tasks;
+	quint64 doneTaskCount = 0;
+
+	for (;;)
+	{
+		bool flushFiles = false;
+		bool quit = false;
+		{
+			QMutexLocker locker(&m_mutex);
+			if (m_tasks.isEmpty()
+			&&  m_flushTarget <= m_flushedTaskCount
+			&&  !m_quit)
+			{
+				// Flush the buffered output if nothing arrives
+				// in a while
+				if (!m_hasUnflushedOutput)
+					m_taskAdded.wait(&m_mutex);
+				else if (!m_taskAdded.wait(&m_mutex, s_idleFlushTime))
+					flushFiles = true;
+			}
+			tasks.swap(m_tasks);
+			flushFiles = flushFiles
+				  || m_flushTarget > m_flushedTaskCount;
+			quit = m_quit && m_tasks.isEmpty();
+		}
+
+		for (const Task& task : std::as_const(tasks))
+			processTask(task);
+		doneTaskCount += tasks.size();
+		tasks.clear();
+
+		if (flushFiles || quit)
+		{
+			this->flushFiles();
+
+			QMutexLocker locker(&m_mutex);
+			m_flushedTaskCount = doneTaskCount;
+			m_tasksFlushed.wakeAll();
+		}
+
+		if (quit)
+			break;
+	}
+
+	if (m_pgnFile.isOpen())
+		m_pgnFile.close();
+	if (m_epdFile.isOpen())
+		m_epdFile.close();
+	if (m_binaryFile.isOpen())
+		m_binaryFile.close();
+}
+
+void GameWriter::processTask(const Task& task)
+{
+	switch (task.type)
+	{
+	case Task::Game:
+	{
+		// Keep only the serialized form of the game until
+		// the earlier games have been written
+		PendingGame game;
+		const bool hasPgn = !m_pgnFile.fileName().isEmpty();
+		const bool hasBinary = !m_binaryFile.fileName().isEmpty();
+		if (task.omit)
+		{
+			if (hasPgn || hasBinary)
+				qWarning("Omitted incomplete game %d", task.gameNumber);
+		}
+		else
+		{
+			if (hasPgn)
+			{
+				QTextStream out(&game.pgn, QIODevice::WriteOnly);
+				if (!task.pgn.write(out, m_pgnMode))
+				{
+					qWarning("Could not write PGN game %d",
+						 task.gameNumber);
+					setError(true);
+				}
+			}
+			if (hasBinary)
+			{
+				game.binary = BinaryGameLog::encode(task.pgn,
+					task.whiteIndex, task.blackIndex,
+					task.openingIndex, m_binaryEvaluations);
+				game.hasBinary = true;
+			}
+		}
+		m_pendingGames[task.gameNumber] = game;
+
+		while (m_pendingGames.contains(m_savedGameCount + 1))
+		{
+			const PendingGame tmp(m_pendingGames.take(++m_savedGameCount));
+			m_pgnBuffer.append(tmp.pgn);
+			if (tmp.hasBinary && hasBinary)
+			{
+				m_binaryRecords.append(tmp.binary);
+				m_binaryRecordSize += tmp.binary.body.size();
+			}
+			m_hasUnflushedOutput = true;
+		}
+
+		if (m_pgnBuffer.size() >= s_blockSize)
+			writeBuffer(m_pgnFile, m_pgnBuffer, "PGN");
+		if (m_binaryRecordSize >= s_blockSize)
+			writeBinaryBuffer();
+		break;
+	}
+	case Task::EpdPosition:
+		if (m_epdFile.fileName().isEmpty())
+			break;
+		m_epdBuffer.append(task.text.toUtf8());
+		m_epdBuffer.append('\n');
+		m_hasUnflushedOutput = true;
+		if (m_epdBuffer.size() >= s_blockSize)
+			writeBuffer(m_epdFile, m_epdBuffer, "EPD");
+		break;
+	case Task::PgnOutput:
+		m_pgnMode = task.mode;
+		if (task.text != m_pgnFile.fileName())
+		{
+			writeBuffer(m_pgnFile, m_pgnBuffer, "PGN");
+			m_pgnFile.close();
+			m_pgnFile.setFileName(task.text);
+			setError(false);
+		}
+		break;
+	case Task::EpdOutput:
+		if (task.text != m_epdFile.fileName())
+		{
+			writeBuffer(m_epdFile, m_epdBuffer, "EPD");
+			m_epdFile.close();
+			m_epdFile.setFileName(task.text);
+			setError(false);
+		}
+		break;
+	case Task::BinaryOutput:
+		m_binaryEvaluations = task.evaluations;
+		if (task.text != m_binaryFile.fileName())
+		{
+			writeBinaryBuffer();
+			m_binaryFile.close();
+			m_binaryFile.setFileName(task.text);
+			delete m_binaryLog;
+			m_binaryLog = nullptr;
+			setError(false);
+		}
+		break;
+	case Task::Reset:
+		m_pendingGames.clear();
+		m_savedGameCount = 0;
+		setError(false);
+		break;
+	}
+}
+
+bool GameWriter::openFile(QFile& file, const char* type)
+{
+	bool isOpen = file.isOpen();
+	if (isOpen && file.exists())
+		return true;
+
+	if (isOpen)
+	{
+		qWarning("%s file %s does not exist. Reopening...",
+			 type, qUtf8Printable(file.fileName()));
+		file.close();
+	}
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		qWarning("Could not open %s file %s",
+			 type, qUtf8Printable(file.fileName()));
+		return false;
+	}
+
+	return true;
+}
+
+bool GameWriter::writeBuffer(QFile& file, QByteArray& buffer,
+			     const char* type)
+{
+	if (buffer.isEmpty())
+		return true;
+	if (file.fileName().isEmpty())
+	{
+		buffer.clear();
+		return true;
+	}
+
+	bool ok = openFile(file, type);
+	if (ok)
+	{
+		ok = (file.write(buffer) == buffer.size()
+		      && file.error() == QFile::NoError);
+		if (!ok)
+			qWarning("Could not write to %s file %s",
+				 type, qUtf8Printable(file.fileName()));
+	}
+	buffer.clear();
+	if (!ok)
+		setError(true);
+
+	return ok;
+}
+
+bool GameWriter::writeBinaryBuffer()
+{
+	if (m_binaryRecords.isEmpty())
+		return true;
+
+	const QVector<BinaryGameLog::Record> records(m_binaryRecords);
+	m_binaryRecords.clear();
+	m_binaryRecordSize = 0;
+	if (m_binaryFile.fileName().isEmpty())
+		return true;
+
+	// The players and tags of a new or reopened file are unknown,
+	// so it starts a new log session
+	const bool wasOpen = m_binaryFile.isOpen() && m_binaryFile.exists();
+	if (!openFile(m_binaryFile, "binary"))
+	{
+		setError(true);
+		return false;
+	}
+	if (!wasOpen || m_binaryLog == nullptr)
+	{
+		delete m_binaryLog;
+		m_binaryLog = new BinaryGameLog(&m_binaryBuffer);
+
+		// A new or emptied file needs a header
+		if (m_binaryFile.size() == 0)
+			m_binaryLog->writeHeader();
+	}
+
+	for (const BinaryGameLog::Record& record : records)
+		m_binaryLog->write(record);
+
+	bool ok = writeBuffer(m_binaryFile, m_binaryBuffer.buffer(), "binary");
+	m_binaryBuffer.seek(0);
+
+	return ok;
+}
+
+void GameWriter::flushFiles()
+{
+	writeBuffer(m_pgnFile, m_pgnBuffer, "PGN");
+	writeBuffer(m_epdFile, m_epdBuffer, "EPD");
+	writeBinaryBuffer();
+
+	if (m_pgnFile.isOpen())
+		m_pgnFile.flush();
+	if (m_epdFile.isOpen())
+		m_epdFile.flush();
+	if (m_binaryFile.isOpen())
+		m_binaryFile.flush();
+
+	m_hasUnflushedOutput = false;
+}
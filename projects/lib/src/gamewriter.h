@@ -0,0 +1,198 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GAMEWRITER_H
+#define GAMEWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFile>
+#include <QBuffer>
+#include <QMap>
+#include <QByteArray>
+#include <QVector>
+#include "pgngame.h"
+#include "binarygamelog.h"
+
+/*!
+ * \brief Writes finished games to files on a background thread
+ *
+ * GameWriter takes the games of a tournament as they finish and
+ * writes them to a PGN file and/or a binary game log in the order of
+ * their game numbers. The final positions of the games can be written
+ * to an EPD file.
+ *
+ * The games are serialized and written by a dedicated thread, so the
+ * caller never waits for file I/O. Games that finish ahead of earlier
+ * game numbers are kept only in their serialized form until they can
+ * be written. Writes are collected into larger blocks, and the files
+ * are flushed when a block is full, when the writer has been idle for
+ * a while, and when flush() is called.
+ */
+class LIB_EXPORT GameWriter
+{
+	public:
+		/*! Creates a new GameWriter and starts its thread. */
+		GameWriter();
+		/*!
+		 * Destroys the GameWriter.
+		 *
+		 * All pending output is written before the thread exits.
+		 */
+		~GameWriter();
+
+		/*!
+		 * Sets the PGN output file to \a fileName and the PGN
+		 * mode to \a mode.
+		 *
+		 * An empty \a fileName disables PGN output.
+		 */
+		void setPgnOutput(const QString& fileName,
+				  PgnGame::PgnMode mode);
+		/*!
+		 * Sets the EPD output file to \a fileName.
+		 *
+		 * An empty \a fileName disables EPD output.
+		 */
+		void setEpdOutput(const QString& fileName);
+		/*!
+		 * Sets the binary game log file to \a fileName.
+		 *
+		 * If \a evaluations is true, the evaluation and time of each
+		 * move are stored in the log. An empty \a fileName disables
+		 * binary output.
+		 *
+		 * \sa BinaryGameLog
+		 */
+		void setBinaryOutput(const QString& fileName, bool evaluations);
+
+		/*!
+		 * Adds \a pgn as game number \a gameNumber.
+		 *
+		 * Game numbers start at 1, and the games are written in
+		 * that order. \a whiteIndex, \a blackIndex and
+		 * \a openingIndex are stored in the binary game log. If
+		 * \a omit is true, the game is skipped with a warning when
+		 * its turn comes.
+		 */
+		void addGame(int gameNumber,
+			     const PgnGame& pgn,
+			     int whiteIndex,
+			     int blackIndex,
+			     int openingIndex,
+			     bool omit = false);
+		/*! Adds \a fen as a line of the EPD output. */
+		void addEpdPosition(const QString& fen);
+
+		/*!
+		 * Blocks until everything added before this call has been
+		 * written and flushed.
+		 */
+		void flush();
+		/*!
+		 * Starts a new sequence of games beginning at game number 1.
+		 *
+		 * Games of the previous sequence that are still waiting for
+		 * earlier game numbers are discarded.
+		 */
+		void reset();
+		/*!
+		 * Returns true if output could not be written.
+		 *
+		 * The games are written in the background, so a failure
+		 * shows up after the call that added the game. The error
+		 * state is cleared by reset() and when an output file is
+		 * changed.
+		 */
+		bool hasError() const;
+
+	private:
+		class WriterThread;
+
+		struct Task
+		{
+			enum Type
+			{
+				Game,
+				EpdPosition,
+				PgnOutput,
+				EpdOutput,
+				BinaryOutput,
+				Reset
+			};
+
+			Type type = Game;
+			int gameNumber = 0;
+			int whiteIndex = 0;
+			int blackIndex = 0;
+			int openingIndex = 0;
+			bool omit = false;
+			bool evaluations = false;
+			PgnGame pgn;
+			QString text;
+			PgnGame::PgnMode mode = PgnGame::Verbose;
+		};
+
+		struct PendingGame
+		{
+			QByteArray pgn;
+			BinaryGameLog::Record binary;
+			bool hasBinary = false;
+		};
+
+		void addTask(const Task& task);
+		void run();
+		void processTask(const Task& task);
+		bool writeBuffer(QFile& file, QByteArray& buffer,
+				 const char* type);
+		bool writeBinaryBuffer();
+		bool openFile(QFile& file, const char* type);
+		void flushFiles();
+		void setError(bool error);
+
+		WriterThread* m_thread;
+
+		mutable QMutex m_mutex;
+		QWaitCondition m_taskAdded;
+		QWaitCondition m_tasksFlushed;
+		QVector<Task> m_tasks;
+		quint64 m_addedTaskCount;
+		quint64 m_flushTarget;
+		quint64 m_flushedTaskCount;
+		bool m_quit;
+		bool m_error;
+
+		// Accessed only by the writer thread
+		QFile m_pgnFile;
+		QFile m_epdFile;
+		QFile m_binaryFile;
+		PgnGame::PgnMode m_pgnMode;
+		bool m_binaryEvaluations;
+		QMap<int, PendingGame> m_pendingGames;
+		int m_savedGameCount;
+		QByteArray m_pgnBuffer;
+		QByteArray m_epdBuffer;
+		QVector<BinaryGameLog::Record> m_binaryRecords;
+		int m_binaryRecordSize;
+		QBuffer m_binaryBuffer;
+		BinaryGameLog* m_binaryLog;
+		bool m_hasUnflushedOutput;
+};
+
+#endif // GAMEWRITER_H
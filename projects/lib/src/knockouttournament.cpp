@@ -290,3 +290,9 @@ QString KnockoutTournament::results() const
 
 	return lines.join('\n');
 }
+
+Tournament::Standings KnockoutTournament::standings() const
+{
+	// The bracket is small, so it's formatted right away
+	return Standings(results());
+}
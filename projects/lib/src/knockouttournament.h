@@ -41,6 +41,7 @@ class LIB_EXPORT KnockoutTournament : public Tournament
 		virtual QString type() const;
 		virtual bool canSetRoundMultiplier() const;
 		virtual QString results() const;
+		virtual Standings standings() const;
 
 	protected:
 		// Inherited from Tournament
@@ -30,7 +30,8 @@ MoveEvaluation::MoveEvaluation()
 	  m_ponderhitRate(0),
 	  m_nodeCount(0),
 	  m_nps(0),
-	  m_tbHits(0)
+	  m_tbHits(0),
+	  m_pvLineCount(0)
 {
 }
 
@@ -49,29 +50,26 @@ bool MoveEvaluation::operator==(const MoveEvaluation& other) const
 	&&  m_nodeCount == other.m_nodeCount
 	&&  m_nps == other.m_nps
 	&&  m_tbHits == other.m_tbHits
-	&&  m_ponderMove == other.m_ponderMove)
+	&&  m_ponderMove == other.m_ponderMove
+	&&  m_pvLineCount == other.m_pvLineCount)
+	{
+		for (int i = 0; i < m_pvLineCount; i++)
+		{
+			const PvLine& line = m_pvLines[i];
+			const PvLine& otherLine = other.m_pvLines[i];
+			if (line.depth != otherLine.depth
+			||  line.score != otherLine.score
+			||  line.pv != otherLine.pv)
+				return false;
+		}
 		return true;
+	}
 	return false;
 }
 
 bool MoveEvaluation::operator!=(const MoveEvaluation& other) const
 {
-	if (m_isBookEval != other.m_isBookEval
-	||  m_isTrusted != other.m_isTrusted
-	||  m_depth != other.m_depth
-	||  m_selDepth != other.m_selDepth
-	||  m_score != other.m_score
-	||  m_time != other.m_time
-	||  m_pvNumber != other.m_pvNumber
-	||  m_pv != other.m_pv
-	||  m_hashUsage != other.m_hashUsage
-	||  m_ponderhitRate != other.m_ponderhitRate
-	||  m_nodeCount != other.m_nodeCount
-	||  m_nps != other.m_nps
-	||  m_tbHits != other.m_tbHits
-	||  m_ponderMove != other.m_ponderMove)
-		return true;
-	return false;
+	return !(*this == other);
 }
 
 bool MoveEvaluation::isEmpty() const
@@ -87,7 +85,8 @@ bool MoveEvaluation::isEmpty() const
 	&&  m_nodeCount == 0
 	&&  m_nps == 0
 	&&  m_tbHits == 0
-	&&  m_ponderMove.isEmpty())
+	&&  m_ponderMove.isEmpty()
+	&&  m_pvLineCount == 0)
 		return true;
 	return false;
 }
@@ -124,23 +123,72 @@ QString MoveEvaluation::scoreText() const
 	if (m_score == NULL_SCORE)
 		return QString();
 
-	QString str;
 	if (depth() > 0)
+		return scoreText(m_score);
+	return QString();
+}
+
+QString MoveEvaluation::scoreText(int score)
+{
+	if (score == NULL_SCORE)
+		return QString();
+
+	QString str;
+	int absScore = qAbs(score);
+	if (score > 0)
+		str += "+";
+
+	// Detect mate-in-n scores
+	if (absScore > MATE_SCORE - 200
+	&&  (absScore = 1000 - (absScore % 1000)) < 200)
 	{
-		int absScore = qAbs(m_score);
-		if (m_score > 0)
-			str += "+";
+		if (score < 0)
+			str += "-";
+		str += "M" + QString::number(absScore);
+	}
+	else
+		str += QString::number(double(score) / 100.0, 'f', 2);
 
-		// Detect mate-in-n scores
-		if (absScore > MATE_SCORE - 200
-		&&  (absScore = 1000 - (absScore % 1000)) < 200)
-		{
-			if (m_score < 0)
-				str += "-";
-			str += "M" + QString::number(absScore);
-		}
-		else
-			str += QString::number(double(m_score) / 100.0, 'f', 2);
+	return str;
+}
+
+QString MoveEvaluation::pgnComment() const
+{
+	if (m_isBookEval)
+		return "book";
+	if (isEmpty())
+		return QString();
+
+	QString str = scoreText();
+	if (m_depth > 0)
+		str += "/" + QString::number(m_depth) + " ";
+
+	int t = m_time;
+	int precision = 0;
+	if (t < 100)
+		precision = 3;
+	else if (t < 1000)
+		precision = 2;
+	else if (t < 10000)
+		precision = 1;
+	if (t == 0)
+		str += "0s";
+	else
+		str += QString::number(double(t / 1000.0), 'f', precision) + 's';
+
+	// The secondary MultiPV lines follow the main eval,
+	// eg. "+0.35/16 5.1s; 2: +0.20/16 Nf3 d5 c4"
+	for (int i = 1; i < m_pvLineCount; i++)
+	{
+		const PvLine& line = m_pvLines[i];
+		if (line.pv.isEmpty())
+			continue;
+
+		str += "; " + QString::number(i + 1) + ": ";
+		if (line.score != NULL_SCORE)
+			str += scoreText(line.score) + "/"
+			     + QString::number(line.depth) + " ";
+		str += line.pv;
 	}
 
 	return str;
@@ -193,6 +241,17 @@ int MoveEvaluation::pvNumber() const
 	return m_pvNumber;
 }
 
+int MoveEvaluation::pvLineCount() const
+{
+	return m_pvLineCount;
+}
+
+const MoveEvaluation::PvLine& MoveEvaluation::pvLine(int index) const
+{
+	Q_ASSERT(index >= 0 && index < m_pvLineCount);
+	return m_pvLines[index];
+}
+
 void MoveEvaluation::clear()
 {
 	m_isBookEval = false;
@@ -208,6 +267,7 @@ void MoveEvaluation::clear()
 	m_ponderhitRate = 0;
 	m_pv.clear();
 	m_ponderMove.clear();
+	m_pvLineCount = 0;
 }
 
 void MoveEvaluation::setBookEval(bool isBookEval)
@@ -280,6 +340,22 @@ void MoveEvaluation::setPvNumber(int number)
 	m_pvNumber = number;
 }
 
+void MoveEvaluation::setPvLine(int pvNumber, int depth, int score, const QString& pv)
+{
+	if (pvNumber < 1 || pvNumber > MAX_PV_LINES)
+		return;
+
+	// Lines that haven't been reported yet are left empty
+	for (int i = m_pvLineCount; i < pvNumber - 1; i++)
+		m_pvLines[i] = PvLine();
+	m_pvLineCount = qMax(m_pvLineCount, pvNumber);
+
+	PvLine& line = m_pvLines[pvNumber - 1];
+	line.depth = depth;
+	line.score = score;
+	line.pv = pv;
+}
+
 void MoveEvaluation::merge(const MoveEvaluation& other)
 {
 	if (other.m_depth)
@@ -307,4 +383,10 @@ void MoveEvaluation::merge(const MoveEvaluation& other)
 		m_score = other.m_score;
 	if (other.m_time)
 		m_time = other.m_time;
+	for (int i = 0; i < other.m_pvLineCount; i++)
+	{
+		const PvLine& line = other.m_pvLines[i];
+		if (line.depth != 0 || !line.pv.isEmpty())
+			setPvLine(i + 1, line.depth, line.score, line.pv);
+	}
 }
@@ -21,6 +21,7 @@
 
 #include <QString>
 #include <QMetaType>
+#include <array>
 
 /*!
  * \brief Evaluation data for a chess move.
@@ -31,6 +32,10 @@
  * could be saved in a PGN file or displayed on the screen.
  *
  * From human players we can only get the move time.
+ *
+ * Engines that search several principal variations at once (MultiPV)
+ * report a score, depth and PV for each line. These are kept in a small
+ * fixed array of PV lines alongside the main evaluation.
  */
 class LIB_EXPORT MoveEvaluation
 {
@@ -41,6 +46,20 @@ class LIB_EXPORT MoveEvaluation
 		/*! A value for a null or empty score. */
 		constexpr static int NULL_SCORE = 0xFFFFFFF;
 
+		/*! The maximum number of stored MultiPV lines. */
+		constexpr static int MAX_PV_LINES = 8;
+
+		/*! One line of a MultiPV search. */
+		struct PvLine
+		{
+			/*! The search depth of the line. */
+			int depth = 0;
+			/*! The score of the line, or NULL_SCORE if unknown. */
+			int score = NULL_SCORE;
+			/*! The principal variation of the line. */
+			QString pv;
+		};
+
 		/*! Constructs an empty MoveEvaluation object. */
 		MoveEvaluation();
 
@@ -83,6 +102,20 @@ class LIB_EXPORT MoveEvaluation
 		 * \note For human players an empty string is returned.
 		 */
 		QString scoreText() const;
+		/*!
+		 * Returns \a score as a string in the same format as
+		 * scoreText(), or an empty string if \a score is NULL_SCORE.
+		 */
+		static QString scoreText(int score);
+		/*!
+		 * Returns the evaluation as a PGN move comment.
+		 *
+		 * The comment has the score, depth and move time, and the
+		 * score, depth and PV of each secondary MultiPV line, eg.
+		 * "+0.35/16 5.1s; 2: +0.20/16 Nf3 d5 c4". A book move's
+		 * comment is "book".
+		 */
+		QString pgnComment() const;
 
 		/*! Move time in milliseconds. */
 		int time() const;
@@ -134,6 +167,20 @@ class LIB_EXPORT MoveEvaluation
 		 */
 		int pvNumber() const;
 
+		/*!
+		 * Returns the number of stored MultiPV lines.
+		 *
+		 * This is the highest PV number reported by the engine, up
+		 * to MAX_PV_LINES. Engines that don't use MultiPV report no
+		 * lines, and their PV is only available through pv().
+		 */
+		int pvLineCount() const;
+		/*!
+		 * Returns the MultiPV line at \a index, where index 0 is the
+		 * line with PV number 1.
+		 */
+		const PvLine& pvLine(int index) const;
+
 
 		/*! Resets everything to zero. */
 		void clear();
@@ -180,6 +227,14 @@ class LIB_EXPORT MoveEvaluation
 		/*! Sets the principal variation number to \a number. */
 		void setPvNumber(int number);
 
+		/*!
+		 * Sets the MultiPV line with PV number \a pvNumber.
+		 *
+		 * The line is updated in place. Lines with a PV number
+		 * larger than MAX_PV_LINES are ignored.
+		 */
+		void setPvLine(int pvNumber, int depth, int score, const QString& pv);
+
 		/*! Merges non-empty parameters of \a other into this eval. */
 		void merge(const MoveEvaluation& other);
 
@@ -198,6 +253,8 @@ class LIB_EXPORT MoveEvaluation
 		quint64 m_tbHits;
 		QString m_pv;
 		QString m_ponderMove;
+		int m_pvLineCount;
+		std::array<PvLine, MAX_PV_LINES> m_pvLines;
 };
 
 Q_DECLARE_METATYPE(MoveEvaluation)
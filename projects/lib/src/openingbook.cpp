@@ -48,7 +48,9 @@ QDataStream& operator<<(QDataStream& out, const OpeningBook* book)
 }
 
 OpeningBook::OpeningBook(AccessMode mode)
-	: m_mode(mode)
+	: m_mode(mode),
+	  m_mappedData(nullptr),
+	  m_mappedCount(0)
 {
 }
 
@@ -72,6 +74,8 @@ bool OpeningBook::read(const QString& filename)
 
 	if (m_mode == Disk)
 		return true;
+	if (m_mode == Mmap)
+		return mapFile();
 
 	m_map.clear();
 	QDataStream in(&file);
@@ -218,10 +222,80 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 	return entries;
 }
 
+OpeningBook::Entry OpeningBook::readEntry(const uchar* data, quint64* key) const
+{
+	QByteArray bytes(QByteArray::fromRawData(
+		reinterpret_cast<const char*>(data), entrySize()));
+	QDataStream in(bytes);
+
+	return readEntry(in, key);
+}
+
+bool OpeningBook::mapFile()
+{
+	m_mappedFile.reset();
+	m_mappedData = nullptr;
+	m_mappedCount = 0;
+
+	QSharedPointer<QFile> file(new QFile(m_filename));
+	if (!file->open(QIODevice::ReadOnly) || file->size() == 0)
+		return false;
+
+	const uchar* data = file->map(0, file->size());
+	if (data == nullptr)
+	{
+		qWarning("Could not map opening book %s to memory: %s",
+			 qUtf8Printable(m_filename),
+			 qUtf8Printable(file->errorString()));
+		return false;
+	}
+
+	m_mappedFile = file;
+	m_mappedData = data;
+	m_mappedCount = file->size() / entrySize();
+
+	return true;
+}
+
+QList<OpeningBook::Entry> OpeningBook::entriesFromMemory(quint64 key) const
+{
+	QList<Entry> entries;
+	if (m_mappedData == nullptr)
+		return entries;
+
+	const qint64 step = entrySize();
+	quint64 entryKey = 0;
+
+	// Binary search for the first entry with a matching key
+	qint64 first = 0;
+	qint64 last = m_mappedCount;
+	while (first < last)
+	{
+		qint64 middle = first + (last - first) / 2;
+		readEntry(m_mappedData + middle * step, &entryKey);
+		if (entryKey < key)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	for (qint64 i = first; i < m_mappedCount; i++)
+	{
+		Entry entry = readEntry(m_mappedData + i * step, &entryKey);
+		if (entryKey != key)
+			break;
+		entries << entry;
+	}
+
+	return entries;
+}
+
 QList<OpeningBook::Entry> OpeningBook::entries(quint64 key) const
 {
 	if (m_mode == Ram)
 		return m_map.values(key);
+	if (m_mode == Mmap)
+		return entriesFromMemory(key);
 	return entriesFromDisk(key);
 }
 
@@ -21,10 +21,12 @@
 
 #include <QtGlobal>
 #include <QMultiMap>
+#include <QSharedPointer>
 #include "board/genericmove.h"
 
 class QString;
 class QDataStream;
+class QFile;
 class PgnGame;
 class PgnStream;
 
@@ -39,6 +41,10 @@ class PgnStream;
  * The opening book can be stored externally in a binary file. When it's needed,
  * it is loaded in memory, and positions can be found quickly by searching
  * the book for Zobrist keys that match the current board position.
+ *
+ * Books that are too large to be loaded in memory can be read directly
+ * from disk or mapped to memory. In both cases the book file must be
+ * sorted by the Zobrist keys, which is the case for Polyglot books.
  */
 class LIB_EXPORT OpeningBook
 {
@@ -47,7 +53,13 @@ class LIB_EXPORT OpeningBook
 		enum AccessMode
 		{
 			Ram,	//!< Load the entire book to RAM
-			Disk	//!< Read moves directly from disk
+			Disk,	//!< Read moves directly from disk
+			/*!
+			 * Map the book file to memory. The mapping is shared
+			 * by copies of the book object, and the entries are
+			 * searched in place without loading them first.
+			 */
+			Mmap
 		};
 
 		/*!
@@ -144,6 +156,18 @@ class LIB_EXPORT OpeningBook
 		 * belongs to the entry.
 		 */
 		virtual Entry readEntry(QDataStream& in, quint64* key) const = 0;
+		/*!
+		 * Reads a book entry from raw book data at \a data.
+		 *
+		 * The entry is stored in the book file format at
+		 * \a data, and is entrySize() bytes long. The
+		 * implementation must set \a key to the hash that
+		 * belongs to the entry.
+		 *
+		 * The default implementation reads the entry with the
+		 * QDataStream version of readEntry().
+		 */
+		virtual Entry readEntry(const uchar* data, quint64* key) const;
 		
 		/*! Writes the key and entry pointed to by \a it, to \a out. */
 		virtual void writeEntry(const Map::const_iterator& it,
@@ -151,10 +175,15 @@ class LIB_EXPORT OpeningBook
 
 	private:
 		QList<Entry> entriesFromDisk(quint64 key) const;
+		QList<Entry> entriesFromMemory(quint64 key) const;
+		bool mapFile();
 
 		AccessMode m_mode;
 		QString m_filename;
 		Map m_map;
+		QSharedPointer<QFile> m_mappedFile;
+		const uchar* m_mappedData;
+		qint64 m_mappedCount;
 };
 
 /*!
@@ -18,22 +18,72 @@
 
 #include "openingsuite.h"
 #include <QFile>
+#include <QSaveFile>
 #include <QTextStream>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QHash>
 #include <algorithm>
+#include <climits>
 #include "pgnstream.h"
 #include "epdrecord.h"
 #include "mersenne.h"
 
+namespace {
+
+const quint32 s_indexMagic = 0x4343494e; // "CCIN"
+const quint16 s_indexVersion = 1;
+// Size of the blocks at the beginning and end of the suite file
+// that are hashed to validate the index
+const qint64 s_signatureBlockSize = 64 * 1024;
+// Size of one file position in the index
+const qint64 s_indexEntrySize = 2 * sizeof(qint64);
+
+// Packs a move into 32 bits: 6 bits for each coordinate of the
+// source and target squares, and 8 bits for the promotion
+quint32 packMove(const Chess::GenericMove& move)
+{
+	const Chess::Square source(move.sourceSquare());
+	const Chess::Square target(move.targetSquare());
+
+	// Null squares (eg. the source of a piece drop) have -1
+	// coordinates, so all coordinates are stored with an offset
+	return quint32(source.file() + 1) << 26
+	     | quint32(source.rank() + 1) << 20
+	     | quint32(target.file() + 1) << 14
+	     | quint32(target.rank() + 1) << 8
+	     | quint32(move.promotion() & 0xff);
+}
+
+Chess::GenericMove unpackMove(quint32 data)
+{
+	return Chess::GenericMove(
+		Chess::Square(int((data >> 26) & 0x3f) - 1,
+			      int((data >> 20) & 0x3f) - 1),
+		Chess::Square(int((data >> 14) & 0x3f) - 1,
+			      int((data >> 8) & 0x3f) - 1),
+		int(data & 0xff));
+}
+
+} // anonymous namespace
+
 OpeningSuite::OpeningSuite(const QString& fen)
 	: m_format(EpdFormat),
 	  m_order(SequentialOrder),
 	  m_gamesRead(0),
 	  m_gameIndex(0),
 	  m_startIndex(0),
+	  m_nextIndex(0),
+	  m_currentIndex(-1),
 	  m_fen(fen),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_cacheEnabled(false),
+	  m_cacheMaxPlies(INT_MAX - 1),
+	  m_saveIndex(false)
 {
 }
 
@@ -46,10 +96,15 @@ OpeningSuite::OpeningSuite(const QString& fileName,
 	  m_gamesRead(0),
 	  m_gameIndex(0),
 	  m_startIndex(startIndex),
+	  m_nextIndex(0),
+	  m_currentIndex(-1),
 	  m_fileName(fileName),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_cacheEnabled(false),
+	  m_cacheMaxPlies(INT_MAX - 1),
+	  m_saveIndex(false)
 {
 }
 
@@ -79,18 +134,30 @@ OpeningSuite::Order OpeningSuite::order() const
 
 bool OpeningSuite::isNull() const
 {
-	return m_epdStream == nullptr && m_pgnStream == nullptr;
+	return m_epdStream == nullptr && m_pgnStream == nullptr
+	    && m_cachedOpenings.isEmpty();
 }
 
-bool OpeningSuite::initialize()
+void OpeningSuite::setCacheEnabled(bool enabled, int maxPlies)
 {
-	if (!m_fen.isEmpty())
-		return true;
+	Q_ASSERT(maxPlies > 0);
 
-	m_gamesRead = 0;
-	m_gameIndex = 0;
-	m_filePositions.clear();
+	m_cacheEnabled = enabled;
+	m_cacheMaxPlies = maxPlies;
+}
+
+void OpeningSuite::setIndexSavingEnabled(bool enabled)
+{
+	m_saveIndex = enabled;
+}
+
+bool OpeningSuite::isCacheEnabled() const
+{
+	return m_cacheEnabled && !m_cachedOpenings.isEmpty();
+}
 
+bool OpeningSuite::openFile()
+{
 	if (m_epdStream != nullptr)
 	{
 		delete m_epdStream->device();
@@ -110,6 +177,7 @@ bool OpeningSuite::initialize()
 		qWarning("Can't open opening suite %s",
 			 qUtf8Printable(m_fileName));
 		delete m_file;
+		m_file = nullptr;
 		return false;
 	}
 
@@ -121,23 +189,53 @@ bool OpeningSuite::initialize()
 	else if (m_format == PgnFormat)
 		m_pgnStream = new PgnStream(m_file);
 
+	return true;
+}
+
+bool OpeningSuite::initialize()
+{
+	if (!m_fen.isEmpty())
+		return true;
+
+	m_gamesRead = 0;
+	m_gameIndex = 0;
+	m_nextIndex = 0;
+	m_currentIndex = -1;
+	m_filePositions.clear();
+	m_cachedOpenings.clear();
+	m_cachedVariants.clear();
+	m_cachedFens.clear();
+	m_cachedMoves.clear();
+
+	if (!openFile())
+		return false;
+
+	if (m_cacheEnabled)
+		return readCache();
+
 	if (m_order == RandomOrder)
 	{
 		// Create a vector of file positions
-		for (;;)
+		if (!readIndex())
 		{
-			FilePosition pos;
-			if (m_format == EpdFormat)
-				pos = getEpdPos();
-			else if (m_format == PgnFormat)
-				pos = getPgnPos();
-			else
-				return false; // should be unreachable
-
-			if (pos.pos == -1)
-				break;
-
-			m_filePositions.append(pos);
+			readFilePositions();
+
+			// Suites in read-only directories are used without
+			// an index
+			const QString indexFile(indexFileName(m_fileName));
+			const QFileInfo dir(QFileInfo(indexFile).absolutePath());
+			if (m_saveIndex
+			&&  !m_filePositions.isEmpty()
+			&&  dir.isWritable()
+			&&  !writeIndex())
+				qWarning("Could not write opening suite index %s",
+					 qUtf8Printable(indexFile));
+		}
+		if (m_filePositions.isEmpty())
+		{
+			qWarning("Opening suite %s is empty",
+				 qUtf8Printable(m_fileName));
+			return false;
 		}
 
 		// use a Knuth shuffle to generate a random permutation
@@ -152,7 +250,9 @@ bool OpeningSuite::initialize()
 
 		m_gameIndex += m_startIndex % m_filePositions.size();
 	}
-	else if (m_order == SequentialOrder)
+	else if (m_order == SequentialOrder
+	     &&  m_startIndex > 0
+	     &&  !seekIndex(m_startIndex))
 	{
 		for (int i = 0; i < m_startIndex; i++)
 		{
@@ -160,20 +260,24 @@ bool OpeningSuite::initialize()
 			if (m_format == EpdFormat)
 			{
 				pos = getEpdPos();
+				m_nextIndex++;
 				if (m_epdStream->atEnd())
 				{
 					qWarning("Start index larger than book size, wrapping after %d.", i + 1);
 					m_epdStream->seek(0);
 					m_epdStream->resetStatus();
+					m_nextIndex = 0;
                                 }
 			}
 			else if (m_format == PgnFormat)
 			{
 				pos = getPgnPos();
+				m_nextIndex++;
 				if (!m_pgnStream->nextGame())
 				{
 					qWarning("Start index larger than book size, wrapping after %d.", i + 1);
 					m_pgnStream->rewind();
+					m_nextIndex = 0;
 				}
 			}
 		}
@@ -193,8 +297,10 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 	}
 	if (isNull())
 		return game;
+	if (!m_cachedOpenings.isEmpty())
+		return cachedGame(maxPlies);
 
-	FilePosition pos = { -1, -1 };
+	FilePosition pos = { -1, -1, m_nextIndex };
 	if (m_order == RandomOrder)
 	{
 		pos = m_filePositions.at(m_gameIndex++);
@@ -221,6 +327,7 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 			m_epdStream->seek(0);
 			m_epdStream->resetStatus();
 			ok = epd.parse(*m_epdStream);
+			pos.index = 0;
 		}
 
 		Chess::Side side(epd.fen().section(' ', 1, 1));
@@ -239,17 +346,27 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 		{
 			m_pgnStream->rewind();
 			ok = game.read(*m_pgnStream, maxPlies);
+			pos.index = 0;
 		}
 	}
 
 	if (ok)
+	{
 		m_gamesRead++;
+		m_currentIndex = pos.index;
+		m_nextIndex = pos.index + 1;
+	}
 	return game;
 }
 
+int OpeningSuite::currentIndex() const
+{
+	return m_currentIndex;
+}
+
 OpeningSuite::FilePosition OpeningSuite::getPgnPos()
 {
-	FilePosition pos = { -1, -1 };
+	FilePosition pos = { -1, -1, -1 };
 	if (!m_pgnStream->nextGame())
 		return pos;
 
@@ -289,7 +406,7 @@ OpeningSuite::FilePosition OpeningSuite::getPgnPos()
 
 OpeningSuite::FilePosition OpeningSuite::getEpdPos()
 {
-	FilePosition pos = { m_file->pos(), -1 };
+	FilePosition pos = { m_file->pos(), -1, -1 };
 
 	while (m_file->readLine().isEmpty())
 	{
@@ -304,3 +421,309 @@ OpeningSuite::FilePosition OpeningSuite::getEpdPos()
 
 	return pos;
 }
+
+void OpeningSuite::readFilePositions()
+{
+	for (;;)
+	{
+		FilePosition pos;
+		if (m_format == EpdFormat)
+			pos = getEpdPos();
+		else
+			pos = getPgnPos();
+
+		if (pos.pos == -1)
+			break;
+
+		pos.index = m_filePositions.size();
+		m_filePositions.append(pos);
+	}
+}
+
+QString OpeningSuite::indexFileName(const QString& fileName)
+{
+	return fileName + ".cci";
+}
+
+bool OpeningSuite::buildIndex(const QString& fileName, Format format)
+{
+	OpeningSuite suite(fileName, format);
+	if (!suite.openFile())
+		return false;
+
+	suite.readFilePositions();
+	return suite.writeIndex();
+}
+
+QByteArray OpeningSuite::fileSignature() const
+{
+	// The size and modification time catch most changes to the
+	// suite. The hash of the beginning and end of the file catches
+	// files that were replaced with their timestamps preserved.
+	QFile file(m_fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+
+	const qint64 size = file.size();
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(file.read(s_signatureBlockSize));
+	if (size > s_signatureBlockSize)
+	{
+		file.seek(qMax(s_signatureBlockSize, size - s_signatureBlockSize));
+		hash.addData(file.read(s_signatureBlockSize));
+	}
+
+	QByteArray signature;
+	QDataStream out(&signature, QIODevice::WriteOnly);
+	out << quint8(m_format)
+	    << size
+	    << QFileInfo(file).lastModified().toMSecsSinceEpoch()
+	    << hash.result();
+
+	return signature;
+}
+
+qint64 OpeningSuite::openIndex(QFile* file) const
+{
+	if (!file->open(QIODevice::ReadOnly))
+		return -1;
+
+	QDataStream in(file);
+	quint32 magic = 0;
+	quint16 version = 0;
+	QByteArray signature;
+	qint64 count = -1;
+	in >> magic >> version;
+	if (in.status() != QDataStream::Ok
+	||  magic != s_indexMagic
+	||  version != s_indexVersion)
+		return -1;
+
+	in >> signature >> count;
+	if (in.status() != QDataStream::Ok
+	||  count < 0
+	||  signature != fileSignature()
+	||  file->size() - file->pos() != count * s_indexEntrySize)
+		return -1;
+
+	return count;
+}
+
+bool OpeningSuite::readIndex()
+{
+	QFile file(indexFileName(m_fileName));
+	const qint64 count = openIndex(&file);
+	if (count <= 0 || count > INT_MAX)
+		return false;
+
+	QDataStream in(&file);
+	m_filePositions.resize(int(count));
+	for (int i = 0; i < m_filePositions.size(); i++)
+	{
+		FilePosition& pos = m_filePositions[i];
+		in >> pos.pos >> pos.lineNumber;
+		pos.index = i;
+	}
+
+	if (in.status() != QDataStream::Ok)
+	{
+		m_filePositions.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool OpeningSuite::seekIndex(int index)
+{
+	QFile file(indexFileName(m_fileName));
+	const qint64 count = openIndex(&file);
+	if (count <= 0)
+		return false;
+
+	if (index >= count)
+		qWarning("Start index larger than book size, wrapping after %lld.", count);
+
+	// Read only the file position of the first opening
+	if (!file.seek(file.pos() + (index % count) * s_indexEntrySize))
+		return false;
+
+	QDataStream in(&file);
+	FilePosition pos;
+	in >> pos.pos >> pos.lineNumber;
+	if (in.status() != QDataStream::Ok)
+		return false;
+
+	if (m_format == EpdFormat)
+	{
+		m_epdStream->seek(pos.pos);
+		m_epdStream->resetStatus();
+	}
+	else if (!m_pgnStream->seek(pos.pos, pos.lineNumber))
+	{
+		m_pgnStream->rewind();
+		return false;
+	}
+	m_nextIndex = int(index % count);
+
+	return true;
+}
+
+bool OpeningSuite::writeIndex() const
+{
+	const QByteArray signature(fileSignature());
+	if (signature.isEmpty())
+		return false;
+
+	// The index is written to a temporary file that replaces the
+	// old index when it's complete, so other instances reading the
+	// same suite never see a half-written index
+	QSaveFile file(indexFileName(m_fileName));
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	QDataStream out(&file);
+	out << s_indexMagic << s_indexVersion
+	    << signature << qint64(m_filePositions.size());
+	for (const FilePosition& pos : m_filePositions)
+		out << pos.pos << pos.lineNumber;
+
+	if (out.status() != QDataStream::Ok)
+	{
+		file.cancelWriting();
+		return false;
+	}
+
+	return file.commit();
+}
+
+bool OpeningSuite::readCache()
+{
+	QHash<QString, int> fenIndexes;
+
+	for (;;)
+	{
+		QString fen;
+		PgnGame game;
+		if (m_format == EpdFormat)
+		{
+			EpdRecord epd;
+			if (!epd.parse(*m_epdStream))
+				break;
+			fen = epd.fen();
+		}
+		else
+		{
+			// The ECO codes of the openings aren't needed, and
+			// neither are the moves past the opening depth
+			if (!game.read(*m_pgnStream, m_cacheMaxPlies, false))
+				break;
+			fen = game.startingFenString();
+		}
+
+		CachedOpening opening = {
+			int(m_cachedOpenings.size()), -1, -1,
+			int(m_cachedMoves.size()), 0
+		};
+		// The moves were validated for the variant of the game
+		const QString variant(game.variant());
+		if (variant != "standard")
+		{
+			opening.variantIndex = m_cachedVariants.indexOf(variant);
+			if (opening.variantIndex == -1)
+			{
+				opening.variantIndex = m_cachedVariants.size();
+				m_cachedVariants.append(variant);
+			}
+		}
+		if (!fen.isEmpty())
+		{
+			// Many openings of a PGN suite share the start position
+			auto it = fenIndexes.constFind(fen);
+			if (it == fenIndexes.constEnd())
+			{
+				it = fenIndexes.insert(fen, m_cachedFens.size());
+				m_cachedFens.append(fen);
+			}
+			opening.fenIndex = it.value();
+		}
+		for (const PgnGame::MoveData& md : game.moves())
+			m_cachedMoves.append(packMove(md.move));
+		opening.moveCount = m_cachedMoves.size() - opening.firstMove;
+
+		m_cachedOpenings.append(opening);
+	}
+
+	// The file isn't needed anymore
+	if (m_epdStream != nullptr)
+	{
+		delete m_epdStream->device();
+		delete m_epdStream;
+		m_epdStream = nullptr;
+	}
+	if (m_pgnStream != nullptr)
+	{
+		delete m_pgnStream->device();
+		delete m_pgnStream;
+		m_pgnStream = nullptr;
+	}
+	m_file = nullptr;
+
+	if (m_cachedOpenings.isEmpty())
+	{
+		qWarning("Opening suite %s is empty",
+			 qUtf8Printable(m_fileName));
+		return false;
+	}
+	m_cachedMoves.squeeze();
+	m_cachedOpenings.squeeze();
+
+	if (m_order == RandomOrder)
+	{
+		// use a Knuth shuffle to generate a random permutation
+		for (int i = 0; i <= m_cachedOpenings.size() - 2; i++)
+		{
+			int j = i + Mersenne::random() % (m_cachedOpenings.size() - i);
+			std::swap(m_cachedOpenings[i], m_cachedOpenings[j]);
+		}
+	}
+
+	if (m_startIndex >= m_cachedOpenings.size())
+		qWarning("Start index larger than book size, wrapping after %lld.", m_cachedOpenings.size());
+
+	m_gameIndex = m_startIndex % m_cachedOpenings.size();
+	return true;
+}
+
+PgnGame OpeningSuite::cachedGame(int maxPlies)
+{
+	const CachedOpening& opening = m_cachedOpenings.at(m_gameIndex++);
+	if (m_gameIndex >= m_cachedOpenings.size())
+		m_gameIndex = 0;
+	m_currentIndex = opening.index;
+
+	PgnGame game;
+	if (opening.variantIndex != -1)
+		game.setTag("Variant", m_cachedVariants.at(opening.variantIndex));
+	if (opening.fenIndex != -1)
+	{
+		const QString& fen = m_cachedFens.at(opening.fenIndex);
+		Chess::Side side(fen.section(' ', 1, 1));
+		game.setStartingFenString(side, fen);
+	}
+
+	const int count = qMin(opening.moveCount, maxPlies);
+	for (int i = 0; i < count; i++)
+	{
+		PgnGame::MoveData md = {
+			0,
+			unpackMove(m_cachedMoves.at(opening.firstMove + i)),
+			QString(),
+			QString()
+		};
+		game.addMove(md, false);
+	}
+
+	m_gamesRead++;
+	return game;
+}
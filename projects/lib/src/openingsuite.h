@@ -20,6 +20,7 @@
 #define OPENINGSUITE_H
 
 #include <QVector>
+#include <QStringList>
 #include "pgngame.h"
 class QString;
 class QFile;
@@ -88,6 +89,48 @@ class LIB_EXPORT OpeningSuite
 		 */
 		bool isNull() const;
 
+		/*!
+		 * Sets the memory cache mode to \a enabled.
+		 *
+		 * In cache mode initialize() decodes every opening of the
+		 * suite once and keeps them in memory in a packed form.
+		 * nextGame() then returns the openings without accessing
+		 * or parsing the file. The games returned in this mode
+		 * contain only the starting position and the moves.
+		 *
+		 * Only the first \a maxPlies plies (halfmoves) of each
+		 * opening are kept, so \a maxPlies should be the largest
+		 * opening depth that is passed to nextGame().
+		 *
+		 * The default is false. The mode takes effect on the next
+		 * call to initialize().
+		 */
+		void setCacheEnabled(bool enabled, int maxPlies = INT_MAX - 1);
+		/*!
+		 * Returns true if the games are returned from the memory
+		 * cache.
+		 *
+		 * The moves of the cached games were validated when the
+		 * cache was built, so they can be replayed without checking
+		 * them again.
+		 *
+		 * \sa ChessGame::setTrustedMoves()
+		 */
+		bool isCacheEnabled() const;
+		/*!
+		 * Sets index saving to \a enabled.
+		 *
+		 * With index saving a random order suite that has no valid
+		 * index writes one when initialize() reads the file
+		 * positions of the openings. Nothing is written if the
+		 * directory of the suite isn't writable.
+		 *
+		 * The default is false.
+		 *
+		 * \sa buildIndex()
+		 */
+		void setIndexSavingEnabled(bool enabled);
+
 		/*!
 		 * Initializes the opening suite.
 		 *
@@ -97,6 +140,13 @@ class LIB_EXPORT OpeningSuite
 		 * openings are parsed from the file, which could take some
 		 * time if the file is large.
 		 *
+		 * If the suite has a valid index file (see buildIndex()), the
+		 * file positions are read from the index instead, and the
+		 * start index of a sequential suite is found without reading
+		 * the openings before it. If index saving is enabled, a
+		 * random order suite without a valid index saves one for
+		 * the next time.
+		 *
 		 * Returns true if successful; otherwise returns false.
 		 */
 		bool initialize();
@@ -105,28 +155,81 @@ class LIB_EXPORT OpeningSuite
 		 * A maximum of \a maxPlies plies (halfmoves) are read.
 		 */
 		PgnGame nextGame(int maxPlies);
+		/*!
+		 * Returns the index of the opening that was returned by the
+		 * last call to nextGame().
+		 *
+		 * The index is the position of the opening in the suite file,
+		 * starting from 0, regardless of the order in which the
+		 * openings are picked. Returns -1 if no opening has been read
+		 * from a file.
+		 */
+		int currentIndex() const;
+
+		/*!
+		 * Returns the name of the index file of the opening suite
+		 * \a fileName.
+		 */
+		static QString indexFileName(const QString& fileName);
+		/*!
+		 * Creates an index of the file positions of the openings in
+		 * \a fileName, which is in \a format format.
+		 *
+		 * The index is saved to indexFileName(), replacing any old
+		 * index in a single step. It stays valid until the size,
+		 * modification time or contents of the suite file change.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		static bool buildIndex(const QString& fileName, Format format);
 
 	private:
 		struct FilePosition
 		{
 			qint64 pos;
 			qint64 lineNumber;
+			int index;
+		};
+		struct CachedOpening
+		{
+			int index;
+			int variantIndex;
+			int fenIndex;
+			int firstMove;
+			int moveCount;
 		};
 
+		bool openFile();
 		FilePosition getPgnPos();
 		FilePosition getEpdPos();
+		void readFilePositions();
+		qint64 openIndex(QFile* file) const;
+		bool readIndex();
+		bool seekIndex(int index);
+		bool writeIndex() const;
+		QByteArray fileSignature() const;
+		bool readCache();
+		PgnGame cachedGame(int maxPlies);
 
 		Format m_format;
 		Order m_order;
 		int m_gamesRead;
 		int m_gameIndex;
 		int m_startIndex;
+		int m_nextIndex;
+		int m_currentIndex;
 		QString m_fileName;
 		QString m_fen;
 		QFile* m_file;
 		QTextStream* m_epdStream;
 		PgnStream* m_pgnStream;
 		QVector<FilePosition> m_filePositions;
+		bool m_cacheEnabled;
+		int m_cacheMaxPlies;
+		bool m_saveIndex;
+		QVector<CachedOpening> m_cachedOpenings;
+		QStringList m_cachedVariants;
+		QStringList m_cachedFens;
+		QVector<quint32> m_cachedMoves;
 };
 
 #endif // OPENINGSUITE_H
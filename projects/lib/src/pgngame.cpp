@@ -53,7 +53,8 @@ QTextStream& operator<<(QTextStream& out, const PgnGame& game)
 
 PgnGame::PgnGame()
 	: m_startingSide(Chess::Side::White),
-	  m_eco(EcoNode::root()),
+	  m_eco(nullptr),
+	  m_ecoPly(0),
 	  m_tagReceiver(nullptr)
 {
 }
@@ -66,7 +67,8 @@ bool PgnGame::isNull() const
 void PgnGame::clear()
 {
 	m_startingSide = Chess::Side();
-	m_eco = EcoNode::root();
+	m_eco = nullptr;
+	m_ecoPly = 0;
 	m_tags.clear();
 	m_moves.clear();
 }
@@ -103,17 +105,44 @@ const QVector<PgnGame::MoveData>& PgnGame::moves() const
 
 void PgnGame::addMove(const MoveData& data, bool addEco)
 {
+	// The position before the move is the one that
+	// the previous move led to
+	if (addEco && !m_moves.isEmpty())
+		classifyPosition(data.key, int(m_moves.size()));
+
 	m_moves.append(data);
+}
 
-	if (addEco) {
-		m_eco = (m_eco && isStandard()) ? m_eco->child(data.moveString)
-						: nullptr;
-		if (m_eco && m_eco->isLeaf())
-		{
-			setTag("ECO", m_eco->ecoCode());
-			setTag("Opening", m_eco->opening());
-			setTag("Variation", m_eco->variation());
-		}
+void PgnGame::addEcoPosition(quint64 key)
+{
+	classifyPosition(key, int(m_moves.size()));
+}
+
+void PgnGame::classifyPosition(quint64 key, int ply)
+{
+	// Each position is classified once, in move order
+	if (ply <= m_ecoPly || ply > EcoNode::maxPly() || !isStandard())
+		return;
+
+	// Follow the ECO tree while the game plays its moves, so that
+	// an opening line gets its own name even if a shorter line
+	// reaches the same position. The position table is only used
+	// for transpositions, once the game has left the tree.
+	const EcoNode* parent = (ply == 1) ? EcoNode::root() : m_eco;
+	const EcoNode* eco = nullptr;
+	const QString& san = m_moves.at(ply - 1).moveString;
+	if (parent != nullptr && ply == m_ecoPly + 1 && !san.isEmpty())
+		eco = parent->child(san);
+	if (eco == nullptr)
+		eco = EcoNode::findPosition(key);
+
+	m_eco = eco;
+	m_ecoPly = ply;
+	if (eco != nullptr && eco->isLeaf())
+	{
+		setTag("ECO", eco->ecoCode());
+		setTag("Opening", eco->opening());
+		setTag("Variation", eco->variation());
 	}
 }
 
@@ -122,6 +151,15 @@ void PgnGame::setMove(int ply, const MoveData& data)
 	m_moves[ply] = data;
 }
 
+void PgnGame::updateEco()
+{
+	m_eco = nullptr;
+	m_ecoPly = 0;
+	const int plies = qMin(int(m_moves.size()), EcoNode::maxPly() + 1);
+	for (int i = 1; i < plies; i++)
+		classifyPosition(m_moves.at(i).key, i);
+}
+
 Chess::Board* PgnGame::createBoard() const
 {
 	Chess::Board* board = Chess::BoardFactory::create(variant());
@@ -264,6 +302,10 @@ bool PgnGame::read(PgnStream& in, int maxMoves, bool addEco)
 	if (m_tags.isEmpty())
 		return false;
 
+	// Classify the position after the last move
+	if (addEco && !m_moves.isEmpty())
+		addEcoPosition(in.board()->key());
+
 	setTag("PlyCount", QString::number(m_moves.size()));
 
 	return true;
@@ -568,7 +610,7 @@ QMap< int, int > PgnGame::extractScores() const
 	for (const auto md: moves())
 	{
 		// Default format: Xboard/concise like {0.35/16 5.1s})
-		// Ref.: ChessGame::evalString and MoveEvaluation::scoreText
+		// Ref.: MoveEvaluation::pgnComment and MoveEvaluation::scoreText
 		int count = scores.count();
 		QString s = md.comment.split('/').at(0);
 		bool isMateScore = s.contains('M');
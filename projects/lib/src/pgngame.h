@@ -90,6 +90,24 @@ class LIB_EXPORT PgnGame
 		 */
 		void addMove(const MoveData& data, bool addEco = true);
 		void setMove(int ply, const MoveData& data);
+		/*!
+		 * Sets the opening information from the position keys of
+		 * all moves in the game.
+		 *
+		 * This is needed if the moves were added without opening
+		 * information. The position after the last move has no key
+		 * in the move list, so it must be added with
+		 * addEcoPosition().
+		 */
+		void updateEco();
+		/*!
+		 * Sets the opening information from the position that the
+		 * last move led to. \a key is the Zobrist key of the position.
+		 *
+		 * addMove() classifies the position before each new move, so
+		 * this is only needed for the final position of a game.
+		 */
+		void addEcoPosition(quint64 key);
 
 		/*!
 		 * Creates a board object for viewing or analyzing the game.
@@ -207,9 +225,11 @@ class LIB_EXPORT PgnGame
 
 	private:
 		bool parseMove(PgnStream& in, bool addEco);
+		void classifyPosition(quint64 key, int ply);
 		
 		Chess::Side m_startingSide;
 		const EcoNode* m_eco;
+		int m_ecoPly;
 		QMap<QString, QString> m_tags;
 		QVector<MoveData> m_moves;
 		QObject* m_tagReceiver;
@@ -21,6 +21,7 @@
 #include <QDataStream>
 #include <QMap>
 #include "pgnstream.h"
+#include "pgngame.h"
 #include "pgngamefilter.h"
 
 namespace {
@@ -104,10 +105,15 @@ PgnGameEntry::PgnGameEntry()
 
 bool PgnGameEntry::match(const PgnGameFilter& filter) const
 {
-	const char* data = m_data.constData();
+	return match(m_data.constData(), m_data.size(), filter);
+}
 
+bool PgnGameEntry::match(const char* data,
+			 int dataSize,
+			 const PgnGameFilter& filter)
+{
 	if (filter.type() == PgnGameFilter::FixedString)
-		return s_stringContains(data, filter.pattern(), m_data.size()) != -1;
+		return s_stringContains(data, filter.pattern(), dataSize) != -1;
 
 	int whitePlayer = 0;
 
@@ -268,6 +274,22 @@ void PgnGameEntry::clear()
 	m_data.clear();
 }
 
+void PgnGameEntry::setGame(const PgnGame& game, qint64 pos, qint64 lineNumber)
+{
+	m_pos = pos;
+	m_lineNumber = lineNumber;
+	m_data.clear();
+
+	addTag(game.tagValue("Event").toUtf8());
+	addTag(game.tagValue("Site").toUtf8());
+	addTag(game.tagValue("Date").toUtf8());
+	addTag(game.tagValue("Round").toUtf8());
+	addTag(game.tagValue("White").toUtf8());
+	addTag(game.tagValue("Black").toUtf8());
+	addTag(game.tagValue("Result").toUtf8());
+	addTag(game.tagValue("Variant").toUtf8());
+}
+
 bool PgnGameEntry::read(PgnStream& in)
 {
 	if (!in.nextGame())
@@ -369,13 +391,18 @@ qint64 PgnGameEntry::lineNumber() const
 }
 
 QString PgnGameEntry::tagValue(TagType type) const
+{
+	return tagValue(m_data.constData(), type);
+}
+
+QString PgnGameEntry::tagValue(const char* data, TagType type)
 {
 	int i = 0;
 	for (int j = 0; j < type; j++)
-		i += m_data[i] + 1;
+		i += data[i] + 1;
 
-	int size = m_data[i];
+	int size = data[i];
 	if (size == 0)
 		return QString();
-	return m_data.mid(i + 1, size);
+	return QString::fromUtf8(data + i + 1, size);
 }
@@ -22,6 +22,7 @@
 #include <QDate>
 #include "board/result.h"
 class PgnStream;
+class PgnGame;
 class PgnGameFilter;
 class QDataStream;
 
@@ -35,7 +36,7 @@ class QDataStream;
  * consumption, which is useful for quickly loading large game
  * collections.
  *
- * \sa PgnGame, PgnStream
+ * \sa PgnGame, PgnStream, PgnGameEntryStore
  */
 class LIB_EXPORT PgnGameEntry
 {
@@ -63,6 +64,11 @@ class LIB_EXPORT PgnGameEntry
 		 * Returns true if successful; otherwise returns false.
 		 */
 		bool read(PgnStream& in);
+		/*!
+		 * Sets the entry's tags to the tags of \a game, which begins
+		 * at stream position \a pos and line number \a lineNumber.
+		 */
+		void setGame(const PgnGame& game, qint64 pos, qint64 lineNumber);
 
 		/*!
 		 * Reads an entry from data stream.
@@ -90,6 +96,12 @@ class LIB_EXPORT PgnGameEntry
 		QString tagValue(TagType type) const;
 
 	private:
+		friend class PgnGameEntryStore;
+
+		static bool match(const char* data,
+				  int dataSize,
+				  const PgnGameFilter& filter);
+		static QString tagValue(const char* data, TagType type);
 		void addTag(const QByteArray& tagValue);
 
 		QByteArray m_data;
@@ -0,0 +1,157 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pgngameentrystore.h"
+#include <QDataStream>
+
+namespace {
+
+// The tags of an entry take at most 8 * 128 bytes, so an entry
+// always fits in a single block
+const int s_blockSize = 1024 * 1024;
+const int s_tagCount = PgnGameEntry::VariantTag + 1;
+
+} // anonymous namespace
+
+PgnGameEntryStore::PgnGameEntryStore()
+{
+}
+
+int PgnGameEntryStore::count() const
+{
+	return m_items.size();
+}
+
+bool PgnGameEntryStore::isEmpty() const
+{
+	return m_items.isEmpty();
+}
+
+void PgnGameEntryStore::clear()
+{
+	m_items.clear();
+	m_blocks.clear();
+}
+
+void PgnGameEntryStore::reserve(int count)
+{
+	m_items.reserve(count);
+}
+
+void PgnGameEntryStore::append(const PgnGameEntry& entry)
+{
+	const QByteArray& tags = entry.m_data;
+
+	if (m_blocks.isEmpty()
+	||  m_blocks.last().size() + qMax<qsizetype>(tags.size(), s_tagCount) > s_blockSize)
+	{
+		m_blocks.append(QByteArray());
+		m_blocks.last().reserve(s_blockSize);
+	}
+
+	QByteArray& block = m_blocks.last();
+	const Item item = {
+		entry.m_pos,
+		entry.m_lineNumber,
+		quint32(m_blocks.size() - 1),
+		quint32(block.size())
+	};
+	if (!tags.isEmpty())
+		block.append(tags);
+	else
+		block.append(s_tagCount, '\0');
+	m_items.append(item);
+}
+
+void PgnGameEntryStore::append(const PgnGameEntryStore& other)
+{
+	if (m_items.isEmpty())
+	{
+		*this = other;
+		return;
+	}
+
+	const quint32 blockOffset = quint32(m_blocks.size());
+	m_blocks.append(other.m_blocks);
+
+	m_items.reserve(m_items.size() + other.m_items.size());
+	for (Item item : other.m_items)
+	{
+		item.block += blockOffset;
+		m_items.append(item);
+	}
+}
+
+const char* PgnGameEntryStore::data(const Item& item) const
+{
+	return m_blocks.at(item.block).constData() + item.offset;
+}
+
+int PgnGameEntryStore::dataSize(const char* data) const
+{
+	int i = 0;
+	for (int j = 0; j < s_tagCount; j++)
+		i += data[i] + 1;
+
+	return i;
+}
+
+PgnGameEntry PgnGameEntryStore::at(int index) const
+{
+	const Item& item = m_items.at(index);
+	const char* tags = data(item);
+
+	PgnGameEntry entry;
+	entry.m_pos = item.pos;
+	entry.m_lineNumber = item.lineNumber;
+	entry.m_data = QByteArray(tags, dataSize(tags));
+
+	return entry;
+}
+
+qint64 PgnGameEntryStore::pos(int index) const
+{
+	return m_items.at(index).pos;
+}
+
+qint64 PgnGameEntryStore::lineNumber(int index) const
+{
+	return m_items.at(index).lineNumber;
+}
+
+QString PgnGameEntryStore::tagValue(int index, PgnGameEntry::TagType type) const
+{
+	return PgnGameEntry::tagValue(data(m_items.at(index)), type);
+}
+
+bool PgnGameEntryStore::match(int index, const PgnGameFilter& filter) const
+{
+	const char* tags = data(m_items.at(index));
+	return PgnGameEntry::match(tags, dataSize(tags), filter);
+}
+
+void PgnGameEntryStore::write(int index, QDataStream& out) const
+{
+	// Must produce the same output as PgnGameEntry::write()
+	const Item& item = m_items.at(index);
+	const char* tags = data(item);
+
+	out << item.pos;
+	out << item.lineNumber;
+	out << QByteArray::fromRawData(tags, dataSize(tags));
+}
@@ -0,0 +1,109 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PGNGAMEENTRYSTORE_H
+#define PGNGAMEENTRYSTORE_H
+
+#include <QVector>
+#include <QByteArray>
+#include "pgngameentry.h"
+class PgnGameFilter;
+class QDataStream;
+
+
+/*!
+ * \brief A compact collection of PGN game entries.
+ *
+ * PgnGameEntryStore keeps the tags of its entries packed into large
+ * contiguous blocks, and the stream positions in a flat array. An
+ * entry is referred to by its index, which doesn't change when more
+ * entries are appended.
+ *
+ * Compared to a list of PgnGameEntry objects this avoids one heap
+ * allocation per entry and keeps the data scanned by match() close
+ * together in memory.
+ *
+ * The store is implicitly shared, so copying it is cheap.
+ *
+ * \sa PgnGameEntry
+ */
+class LIB_EXPORT PgnGameEntryStore
+{
+	public:
+		/*! Creates a new empty store. */
+		PgnGameEntryStore();
+
+		/*! Returns the number of entries in the store. */
+		int count() const;
+		/*! Returns true if the store has no entries. */
+		bool isEmpty() const;
+		/*! Removes all entries from the store. */
+		void clear();
+		/*! Reserves space for \a count entries. */
+		void reserve(int count);
+
+		/*! Appends \a entry to the store. */
+		void append(const PgnGameEntry& entry);
+		/*!
+		 * Appends all entries in \a other to the store.
+		 *
+		 * The tag data blocks of \a other are shared, not copied.
+		 */
+		void append(const PgnGameEntryStore& other);
+
+		/*! Returns a copy of the entry at \a index. */
+		PgnGameEntry at(int index) const;
+		/*! Returns the stream position of the entry at \a index. */
+		qint64 pos(int index) const;
+		/*! Returns the line number of the entry at \a index. */
+		qint64 lineNumber(int index) const;
+		/*!
+		 * Returns the value of tag \a type of the entry at \a index.
+		 */
+		QString tagValue(int index, PgnGameEntry::TagType type) const;
+		/*!
+		 * Returns true if the tags of the entry at \a index
+		 * match \a filter.
+		 *
+		 * \sa PgnGameEntry::match()
+		 */
+		bool match(int index, const PgnGameFilter& filter) const;
+
+		/*!
+		 * Writes the entry at \a index to \a out in the same
+		 * format as PgnGameEntry::write().
+		 */
+		void write(int index, QDataStream& out) const;
+
+	private:
+		struct Item
+		{
+			qint64 pos;
+			qint64 lineNumber;
+			quint32 block;
+			quint32 offset;
+		};
+
+		const char* data(const Item& item) const;
+		int dataSize(const char* data) const;
+
+		QVector<Item> m_items;
+		QVector<QByteArray> m_blocks;
+};
+
+#endif // PGNGAMEENTRYSTORE_H
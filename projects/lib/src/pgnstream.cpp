@@ -24,6 +24,8 @@
 
 namespace {
 
+const int s_blockSize = 64 * 1024;
+
 void skipSection(PgnStream* in, char start)
 {
 	char end;
@@ -59,9 +61,12 @@ void skipSection(PgnStream* in, char start)
 
 PgnStream::PgnStream(const QString& variant)
 	: m_board(nullptr),
+	  m_data(nullptr),
+	  m_dataSize(0),
+	  m_dataOffset(0),
 	  m_pos(0),
 	  m_lineNumber(1),
-	  m_lastChar(0),
+	  m_skipCr(false),
 	  m_tokenType(NoToken),
 	  m_device(nullptr),
 	  m_string(nullptr),
@@ -72,14 +77,16 @@ PgnStream::PgnStream(const QString& variant)
 }
 
 PgnStream::PgnStream(QIODevice* device, const QString& variant)
-	: m_board(nullptr)
+	: m_board(nullptr),
+	  m_skipCr(false)
 {
 	setVariant(variant);
 	setDevice(device);
 }
 
 PgnStream::PgnStream(const QByteArray* string, const QString& variant)
-	: m_board(nullptr)
+	: m_board(nullptr),
+	  m_skipCr(false)
 {
 	setVariant(variant);
 	setString(string);
@@ -87,14 +94,20 @@ PgnStream::PgnStream(const QByteArray* string, const QString& variant)
 
 PgnStream::~PgnStream()
 {
+	restoreTextMode();
 	delete m_board;
 }
 
 void PgnStream::reset()
 {
+	restoreTextMode();
+
+	m_data = nullptr;
+	m_dataSize = 0;
+	m_dataOffset = 0;
 	m_pos = 0;
 	m_lineNumber = 1;
-	m_lastChar = 0;
+	m_skipCr = false;
 	m_tokenString.clear();
 	m_tagName.clear();
 	m_tagValue.clear();
@@ -121,6 +134,24 @@ void PgnStream::setDevice(QIODevice* device)
 
 	reset();
 	m_device = device;
+	if (device == nullptr)
+		return;
+
+	if (!device->isSequential())
+		m_dataOffset = device->pos();
+	if (device->isTextModeEnabled())
+	{
+		device->setTextModeEnabled(false);
+		m_skipCr = true;
+	}
+}
+
+void PgnStream::restoreTextMode()
+{
+	// Give the device back in the mode it was in before setDevice()
+	if (m_skipCr && m_device != nullptr && m_device->isOpen())
+		m_device->setTextModeEnabled(true);
+	m_skipCr = false;
 }
 
 const QByteArray* PgnStream::string() const
@@ -133,6 +164,8 @@ void PgnStream::setString(const QByteArray* string)
 	Q_ASSERT(string != nullptr);
 	reset();
 	m_string = string;
+	m_data = string->constData();
+	m_dataSize = string->size();
 }
 
 QString PgnStream::variant() const
@@ -162,9 +195,7 @@ bool PgnStream::isOpen() const
 
 qint64 PgnStream::pos() const
 {
-	if (m_device)
-		return m_device->pos();
-	return m_pos;
+	return m_dataOffset + m_pos;
 }
 
 qint64 PgnStream::lineNumber() const
@@ -172,32 +203,56 @@ qint64 PgnStream::lineNumber() const
 	return m_lineNumber;
 }
 
+bool PgnStream::fillBuffer()
+{
+	if (m_string)
+	{
+		// The string may have grown since the last read
+		m_data = m_string->constData();
+		m_dataSize = m_string->size();
+		return m_pos < m_dataSize;
+	}
+	if (!m_device)
+		return false;
+
+	// Keep the last character of the previous block at the start of
+	// the buffer so that rewindChar() works across block boundaries
+	const int keep = m_dataSize > 0 ? 1 : 0;
+	if (m_buffer.size() < s_blockSize + 1)
+		m_buffer.resize(s_blockSize + 1);
+
+	const char last = keep ? m_data[m_dataSize - 1] : 0;
+	qint64 n = m_device->read(m_buffer.data() + 1, s_blockSize);
+	if (n <= 0)
+		return false;
+
+	m_buffer[0] = last;
+	m_dataOffset += m_dataSize - keep;
+	m_data = m_buffer.constData() + 1 - keep;
+	m_dataSize = n + keep;
+	m_pos = keep;
+
+	return true;
+}
+
 char PgnStream::readChar()
 {
-	char c;
-	if (m_device)
+	for (;;)
 	{
-		if (!m_device->getChar(&m_lastChar))
+		if (m_pos >= m_dataSize && !fillBuffer())
 		{
 			m_status = ReadPastEnd;
 			return 0;
 		}
-		c = m_lastChar;
-	}
-	else if (m_string && m_pos < m_string->size())
-	{
-		c = m_string->at(m_pos++);
-	}
-	else
-	{
-		m_status = ReadPastEnd;
-		return 0;
-	}
 
-	if (c == '\n')
-		m_lineNumber++;
+		const char c = m_data[m_pos++];
+		if (c == '\n')
+			m_lineNumber++;
+		else if (c == '\r' && m_skipCr)
+			continue;
 
-	return c;
+		return c;
+	}
 }
 
 void PgnStream::rewind()
@@ -207,21 +262,11 @@ void PgnStream::rewind()
 
 void PgnStream::rewindChar()
 {
-	Q_ASSERT(pos() > 0);
-
-	char c;
-	if (m_device)
-	{
-		c = m_lastChar;
-		m_device->ungetChar(m_lastChar);
-		m_lastChar = 0;
-	}
-	else if (m_string)
-		c = m_string->at(m_pos--);
-	else
+	Q_ASSERT(m_pos > 0);
+	if (m_pos <= 0)
 		return;
 
-	if (c == '\n')
+	if (m_data[--m_pos] == '\n')
 		m_lineNumber--;
 }
 
@@ -233,12 +278,25 @@ bool PgnStream::seek(qint64 pos, qint64 lineNumber)
 	bool ok = false;
 	if (m_device)
 	{
-		ok = m_device->seek(pos);
-		m_pos = 0;
+		// Seeking within the buffered block doesn't need any I/O
+		if (pos >= m_dataOffset && pos < m_dataOffset + m_dataSize)
+		{
+			m_pos = pos - m_dataOffset;
+			ok = true;
+		}
+		else if ((ok = m_device->seek(pos)))
+		{
+			m_data = nullptr;
+			m_dataSize = 0;
+			m_dataOffset = pos;
+			m_pos = 0;
+		}
 	}
 	else if (m_string)
 	{
 		ok = pos < m_string->size();
+		m_data = m_string->constData();
+		m_dataSize = m_string->size();
 		m_pos = pos;
 	}
 	if (!ok)
@@ -246,7 +304,6 @@ bool PgnStream::seek(qint64 pos, qint64 lineNumber)
 
 	m_status = Ok;
 	m_lineNumber = lineNumber;
-	m_lastChar = 0;
 	m_phase = OutOfGame;
 
 	return true;
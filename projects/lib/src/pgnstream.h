@@ -21,6 +21,8 @@
 
 #include <QtGlobal>
 #include <QString>
+#include <QByteArray>
+#include <QPointer>
 class QIODevice;
 namespace Chess { class Board; }
 
@@ -30,7 +32,9 @@ namespace Chess { class Board; }
  *
  * PgnStream is used for reading PGN games from a QIODevice or a string.
  * It has its own input methods, and keeps track of the current line
- * number which can be used to report errors in the games. PgnStream
+ * number which can be used to report errors in the games. Devices are
+ * read in large blocks into an internal buffer, so the stream owns the
+ * read position of the device until seek() is called. PgnStream
  * also has its own Chess::Board object, so that the same board can be
  * easily used with all the games in the stream. The chess variant can
  * be changed at any time, so it's possible to read PGN streams that
@@ -104,7 +108,15 @@ class LIB_EXPORT PgnStream
 
 		/*! Returns the assigned device, or 0 if no device is in use. */
 		QIODevice* device() const;
-		/*! Sets the current device to \a device. */
+		/*!
+		 * Sets the current device to \a device.
+		 *
+		 * If \a device is in text mode, text mode is disabled and the
+		 * stream drops carriage returns by itself. This way pos() and
+		 * seek() always refer to byte offsets in the device. Text mode
+		 * is enabled again when the device is replaced, the stream is
+		 * reset or the stream is destroyed.
+		 */
 		void setDevice(QIODevice* device);
 
 		/*! Returns the assigned string, or 0 if no string is in use. */
@@ -200,19 +212,25 @@ class LIB_EXPORT PgnStream
 			InGame
 		};
 
+		bool fillBuffer();
 		void parseUntil(const char* chars);
 		void parseTag();
 		void parseComment(char opBracket);
+		void restoreTextMode();
 
 		Chess::Board* m_board;
+		const char* m_data;
+		qint64 m_dataSize;
+		qint64 m_dataOffset;
 		qint64 m_pos;
 		qint64 m_lineNumber;
-		char m_lastChar;
+		bool m_skipCr;
+		QByteArray m_buffer;
 		QByteArray m_tokenString;
 		QByteArray m_tagName;
 		QByteArray m_tagValue;
 		TokenType m_tokenType;
-		QIODevice* m_device;
+		QPointer<QIODevice> m_device;
 		const QByteArray* m_string;
 		Status m_status;
 		Phase m_phase;
@@ -18,6 +18,7 @@
 
 #include "polyglotbook.h"
 #include <QDataStream>
+#include <QtEndian>
 
 namespace {
 
@@ -77,6 +78,17 @@ OpeningBook::Entry PolyglotBook::readEntry(QDataStream& in, quint64* key) const
 	return { moveFromBits(pgMove), weight };
 }
 
+OpeningBook::Entry PolyglotBook::readEntry(const uchar* data, quint64* key) const
+{
+	// The entries are stored in big-endian byte order:
+	// key (8 bytes), move (2), weight (2) and learn (4)
+	*key = qFromBigEndian<quint64>(data);
+	quint16 pgMove = qFromBigEndian<quint16>(data + 8);
+	quint16 weight = qFromBigEndian<quint16>(data + 10);
+
+	return { moveFromBits(pgMove), weight };
+}
+
 void PolyglotBook::writeEntry(const Map::const_iterator& it,
 			      QDataStream& out) const
 {
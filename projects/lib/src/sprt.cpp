@@ -137,7 +137,9 @@ Sprt::Sprt()
 	  m_beta(0),
 	  m_wins(0),
 	  m_losses(0),
-	  m_draws(0)
+	  m_draws(0),
+	  m_pairs{0, 0, 0, 0, 0},
+	  m_model(Trinomial)
 {
 }
 
@@ -155,7 +157,64 @@ void Sprt::initialize(double elo0, double elo1,
 	m_beta = beta;
 }
 
+Sprt::Model Sprt::model() const
+{
+	return m_model;
+}
+
+void Sprt::setModel(Model model)
+{
+	m_model = model;
+}
+
 Sprt::Status Sprt::status() const
+{
+	Status status = (m_model == Pentanomial) ? pentanomialStatus()
+						  : trinomialStatus();
+
+	// Bounds based on error levels of the test
+	status.lBound = std::log(m_beta / (1.0 - m_alpha));
+	status.uBound = std::log((1.0 - m_beta) / m_alpha);
+
+	if (status.llr >= status.uBound)
+		status.result = AcceptH1;
+	else if (status.llr <= status.lBound)
+		status.result = AcceptH0;
+
+	return status;
+}
+
+int Sprt::gameCount() const
+{
+	if (m_model == Pentanomial)
+	{
+		int pairs = 0;
+		for (int i = 0; i < 5; i++)
+			pairs += m_pairs[i];
+		return pairs * 2;
+	}
+
+	return m_wins + m_losses + m_draws;
+}
+
+Sprt::Result Sprt::expectedResult(int games) const
+{
+	const Status status = this->status();
+	const int count = gameCount();
+	if (games <= 0 || games > count || status.result != Continue)
+		return status.result;
+
+	// The LLR starts from (about) zero, so its average drift per
+	// game is the current LLR divided by the number of games
+	const double llr = status.llr + status.llr / count * games;
+	if (llr >= status.uBound)
+		return AcceptH1;
+	if (llr <= status.lBound)
+		return AcceptH0;
+	return Continue;
+}
+
+Sprt::Status Sprt::trinomialStatus() const
 {
 	Status status = {
 		Continue,
@@ -189,14 +248,53 @@ Sprt::Status Sprt::status() const
 		     losses * std::log(p1.pLoss() / p0.pLoss()) +
 		     draws * std::log(p1.pDraw() / p0.pDraw());
 
-	// Bounds based on error levels of the test
-	status.lBound = std::log(m_beta / (1.0 - m_alpha));
-	status.uBound = std::log((1.0 - m_beta) / m_alpha);
+	return status;
+}
 
-	if (status.llr >= status.uBound)
-		status.result = AcceptH1;
-	else if (status.llr <= status.lBound)
-		status.result = AcceptH0;
+Sprt::Status Sprt::pentanomialStatus() const
+{
+	Status status = {
+		Continue,
+		0.0,
+		0.0,
+		0.0
+	};
+
+	// A small amount is added to each class to keep the variance
+	// positive when some of the pair results haven't occurred yet
+	double counts[5];
+	double pairs = 0.0;
+	for (int i = 0; i < 5; i++)
+	{
+		if (m_pairs[i] < 0)
+			return status;
+		counts[i] = m_pairs[i] + 1e-3;
+		pairs += counts[i];
+	}
+
+	// Mean and variance of the pair score, scaled to [0, 1]
+	double mean = 0.0;
+	for (int i = 0; i < 5; i++)
+		mean += counts[i] / pairs * i / 4.0;
+	double variance = 0.0;
+	for (int i = 0; i < 5; i++)
+	{
+		const double d = i / 4.0 - mean;
+		variance += counts[i] / pairs * d * d;
+	}
+
+	// The observations are game pairs, so the normalized score and
+	// the normalized Elo bounds (which are per game) are scaled to
+	// a pair: the standard deviation of a pair's mean score is
+	// 1 / sqrt(2) times that of a single game.
+	const double nEloScale = 800.0 / std::log(10.0);
+	const double t = (mean - 0.5) / std::sqrt(variance);
+	const double t0 = std::sqrt(2.0) * m_elo0 / nEloScale;
+	const double t1 = std::sqrt(2.0) * m_elo1 / nEloScale;
+
+	// Generalized Log-Likelyhood Ratio
+	status.llr = pairs / 2.0 * std::log((1.0 + (t - t0) * (t - t0)) /
+					    (1.0 + (t - t1) * (t - t1)));
 
 	return status;
 }
@@ -210,3 +308,19 @@ void Sprt::addGameResult(GameResult result)
 	else if (result == Loss)
 		m_losses++;
 }
+
+void Sprt::addGamePairResult(GameResult first, GameResult second)
+{
+	if (first == NoResult || second == NoResult)
+		return;
+
+	auto score = [](GameResult result)
+	{
+		if (result == Win)
+			return 2;
+		if (result == Draw)
+			return 1;
+		return 0;
+	};
+	m_pairs[score(first) + score(second)]++;
+}
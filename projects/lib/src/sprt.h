@@ -27,6 +27,12 @@
  * players when the Elo difference is known to be outside of the specified
  * interval.
  *
+ * The default trinomial model counts wins, losses and draws of single
+ * games. The pentanomial model counts the results of game pairs played
+ * with the same opening, which takes the correlation between the games
+ * of a pair into account and usually needs fewer games to reach a
+ * decision. Its Elo bounds are normalized Elo values.
+ *
  * \sa http://en.wikipedia.org/wiki/Sequential_probability_ratio_test
  */
 class LIB_EXPORT Sprt
@@ -49,6 +55,13 @@ class LIB_EXPORT Sprt
 			Draw		//!< Game was drawn
 		};
 
+		/*! The statistical model of the test. */
+		enum Model
+		{
+			Trinomial,	//!< Win/loss/draw counts of single games
+			Pentanomial	//!< Scores of game pairs
+		};
+
 		/*! The status of the test. */
 		struct Status
 		{
@@ -78,8 +91,28 @@ class LIB_EXPORT Sprt
 		 */
 		void initialize(double elo0, double elo1,
 				double alpha, double beta);
+		/*! Returns the statistical model of the test. */
+		Model model() const;
+		/*!
+		 * Sets the statistical model of the test to \a model.
+		 *
+		 * The default model is Trinomial.
+		 */
+		void setModel(Model model);
 		/*! Returns the current status of the test. */
 		Status status() const;
+		/*! Returns the number of games counted in the test. */
+		int gameCount() const;
+		/*!
+		 * Returns the expected result of the test after \a games
+		 * more games.
+		 *
+		 * The log-likelihood ratio is extrapolated with its average
+		 * change per game so far. The extrapolation isn't trusted
+		 * beyond the number of games counted so far, so the current
+		 * result is returned if \a games is larger than gameCount().
+		 */
+		Result expectedResult(int games) const;
 		/*!
 		 * Updates the test with \a result.
 		 *
@@ -87,8 +120,21 @@ class LIB_EXPORT Sprt
 		 * check if H0 or H1 can be accepted.
 		 */
 		void addGameResult(GameResult result);
+		/*!
+		 * Updates the test with the results of a game pair.
+		 *
+		 * \a first and \a second are the results of two games
+		 * played with the same opening. The pair is ignored if
+		 * either game has no result.
+		 *
+		 * \sa Pentanomial
+		 */
+		void addGamePairResult(GameResult first, GameResult second);
 
 	private:
+		Status trinomialStatus() const;
+		Status pentanomialStatus() const;
+
 		double m_elo0;
 		double m_elo1;
 		double m_alpha;
@@ -96,6 +142,9 @@ class LIB_EXPORT Sprt
 		int m_wins;
 		int m_losses;
 		int m_draws;
+		// Game pair counts indexed by the pair's score in half points
+		int m_pairs[5];
+		Model m_model;
 };
 
 #endif // SPRT_H
@@ -17,7 +17,6 @@
 
 
 #include "tournament.h"
-#include <QFile>
 #include <QMultiMap>
 #include <QSet>
 #include "gamemanager.h"
@@ -29,6 +28,7 @@
 #include "openingsuite.h"
 #include "openingbook.h"
 #include "sprt.h"
+#include "gamewriter.h"
 #include "elo.h"
 
 
@@ -41,7 +41,6 @@ Tournament::Tournament(GameManager* gameManager, QObject *parent)
 	  m_oldRound(-1),
 	  m_nextGameNumber(0),
 	  m_finishedGameCount(0),
-	  m_savedGameCount(0),
 	  m_finalGameCount(0),
 	  m_gamesPerEncounter(1),
 	  m_roundMultiplier(1),
@@ -49,20 +48,26 @@ Tournament::Tournament(GameManager* gameManager, QObject *parent)
 	  m_openingDepth(1024),
 	  m_seedCount(0),
 	  m_stopping(false),
+	  m_sprtDrain(false),
+	  m_sprtDraining(false),
 	  m_openingRepetitions(1),
 	  m_openingPolicy(DefaultPolicy),
 	  m_recover(false),
 	  m_pgnCleanup(true),
+	  m_lazySan(false),
 	  m_pgnWriteUnfinishedGames(true),
 	  m_finished(false),
 	  m_bookOwnership(false),
 	  m_openingSuite(nullptr),
 	  m_sprt(new Sprt),
+	  m_gameWriter(new GameWriter),
+	  m_repeatOpening(false),
 	  m_repetitionCounter(0),
+	  m_openingCount(0),
+	  m_openingIndex(-1),
 	  m_swapSides(true),
 	  m_reverseSides(false),
 	  m_resultFormat(c_defaultFormat),
-	  m_pgnOutMode(PgnGame::Verbose),
 	  m_pair(nullptr)
 {
 	Q_ASSERT(gameManager != nullptr);
@@ -128,12 +133,7 @@ Tournament::~Tournament()
 
 	delete m_openingSuite;
 	delete m_sprt;
-
-	if (m_pgnFile.isOpen())
-		m_pgnFile.close();
-
-	if (m_epdFile.isOpen())
-		m_epdFile.close();
+	delete m_gameWriter;
 }
 
 GameManager* Tournament::gameManager() const
@@ -211,6 +211,11 @@ Sprt* Tournament::sprt() const
 	return m_sprt;
 }
 
+void Tournament::setSprtDrainEnabled(bool enabled)
+{
+	m_sprtDrain = enabled;
+}
+
 bool Tournament::canSetRoundMultiplier() const
 {
 	return true;
@@ -320,12 +325,8 @@ const QMap<QString,QString>& Tournament::resultFieldGroups() const
 
 void Tournament::setPgnOutput(const QString& fileName, PgnGame::PgnMode mode)
 {
-	if (fileName != m_pgnFile.fileName())
-	{
-		m_pgnFile.close();
-		m_pgnFile.setFileName(fileName);
-	}
-	m_pgnOutMode = mode;
+	m_pgnFileName = fileName;
+	m_gameWriter->setPgnOutput(fileName, mode);
 }
 
 void Tournament::setPgnWriteUnfinishedGames(bool enabled)
@@ -338,13 +339,21 @@ void Tournament::setPgnCleanupEnabled(bool enabled)
 	m_pgnCleanup = enabled;
 }
 
+void Tournament::setLazySan(bool enabled)
+{
+	m_lazySan = enabled;
+}
+
 void Tournament::setEpdOutput(const QString& fileName)
 {
-	if (fileName != m_epdFile.fileName())
-	{
-		m_epdFile.close();
-		m_epdFile.setFileName(fileName);
-	}
+	m_epdFileName = fileName;
+	m_gameWriter->setEpdOutput(fileName);
+}
+
+void Tournament::setBinaryOutput(const QString& fileName, bool evaluations)
+{
+	m_binaryFileName = fileName;
+	m_gameWriter->setBinaryOutput(fileName, evaluations);
 }
 
 void Tournament::setOpeningRepetitions(int count)
@@ -357,6 +366,15 @@ void Tournament::setOpeningPolicy(Tournament::OpeningPolicy policy)
 	m_openingPolicy = policy;
 }
 
+bool Tournament::playsGamePairs() const
+{
+	if (!m_swapSides || m_gamesPerEncounter % 2 != 0)
+		return false;
+	if (m_openingPolicy != DefaultPolicy)
+		return true;
+	return m_openingRepetitions % 2 == 0;
+}
+
 void Tournament::setReverseSides(bool enabled)
 {
 	m_reverseSides = enabled;
@@ -376,6 +394,8 @@ void Tournament::addPlayer(PlayerBuilder* builder,
 
 	TournamentPlayer player(builder, timeControl, book, bookDepth);
 	m_players.append(player);
+	m_rankingData.append(RankingData());
+	updateRankingData(m_players.size() - 1);
 }
 
 TournamentPair* Tournament::currentPair() const
@@ -433,26 +453,37 @@ void Tournament::startGame(TournamentPair* pair)
 	connect(game, SIGNAL(finished(ChessGame*)),
 		this, SLOT(onGameFinished(ChessGame*)));
 
+	game->setLazySan(m_lazySan);
 	game->setTimeControl(white.timeControl(), Chess::Side::White);
 	game->setTimeControl(black.timeControl(), Chess::Side::Black);
 
 	game->setOpeningBook(white.book(), Chess::Side::White, white.bookDepth());
 	game->setOpeningBook(black.book(), Chess::Side::Black, black.bookDepth());
 
-	if (!m_startFen.isEmpty() || !m_openingMoves.isEmpty())
+	// An empty opening is repeated too, so that the games of a
+	// pair can be matched even without an opening suite or book
+	if (m_repeatOpening)
 	{
 		game->setStartingFen(m_startFen);
 		game->setMoves(m_openingMoves);
 		m_startFen.clear();
 		m_openingMoves.clear();
+		m_repeatOpening = false;
 		m_repetitionCounter++;
 	}
 	else
 	{
 		m_repetitionCounter = 1;
+		m_openingCount++;
+		m_openingIndex = -1;
 		if (m_openingSuite != nullptr)
 		{
-			if (!game->setMoves(m_openingSuite->nextGame(m_openingDepth)))
+			const PgnGame opening(m_openingSuite->nextGame(m_openingDepth));
+			m_openingIndex = m_openingSuite->currentIndex();
+			const bool ok = m_openingSuite->isCacheEnabled() ?
+				game->setTrustedMoves(opening) :
+				game->setMoves(opening);
+			if (!ok)
 				qWarning("The opening suite is incompatible with the "
 				"current chess variant");
 		}
@@ -468,6 +499,7 @@ void Tournament::startGame(TournamentPair* pair)
 			game->setStartingFen(m_startFen);
 		}
 		m_openingMoves = game->moves();
+		m_repeatOpening = true;
 	}
 
 	game->pgn()->setEvent(m_name);
@@ -482,6 +514,9 @@ void Tournament::startGame(TournamentPair* pair)
 	data->number = ++m_nextGameNumber;
 	data->whiteIndex = m_pair->firstPlayer();
 	data->blackIndex = m_pair->secondPlayer();
+	data->openingNumber = m_openingCount;
+	data->repetition = m_repetitionCounter;
+	data->openingIndex = m_openingIndex;
 	m_gameData[game] = data;
 
 	// Some tournament types may require more games than expected
@@ -522,8 +557,13 @@ int Tournament::playerIndex(ChessGame* game, Chess::Side side) const
 
 void Tournament::startNextGame()
 {
-	if (m_stopping)
+	if (m_stopping || m_sprtDraining)
+		return;
+	if (isSprtExpectedToConclude())
+	{
+		pauseSprtDispatch();
 		return;
+	}
 
 	TournamentPair* pair(nextPair(m_nextGameNumber));
 	if (!pair || !pair->isValid())
@@ -540,6 +580,7 @@ void Tournament::startNextGame()
 	{
 		m_startFen.clear();
 		m_openingMoves.clear();
+		m_repeatOpening = false;
 		m_repetitionCounter = 1;
 		m_oldRound = m_round;
 	}
@@ -555,93 +596,39 @@ inline bool faulty(const Chess::Result::Type& type)
 	    || type == Chess::Result::StalledConnection;
 }
 
-bool Tournament::writePgn(PgnGame* pgn, int gameNumber)
+bool Tournament::writePgn(PgnGame* pgn,
+			  int gameNumber,
+			  int whiteIndex,
+			  int blackIndex,
+			  int openingIndex)
 {
 	Q_ASSERT(pgn != nullptr);
 	Q_ASSERT(gameNumber > 0);
 
-	if (m_pgnFile.fileName().isEmpty())
+	if (m_pgnFileName.isEmpty() && m_binaryFileName.isEmpty())
 		return true;
 
-	bool isOpen = m_pgnFile.isOpen();
-	if (!isOpen || !m_pgnFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("PGN file %s does not exist. Reopening...",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			m_pgnFile.close();
-		}
-
-		if (!m_pgnFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open PGN file %s",
-				 qUtf8Printable(m_pgnFile.fileName()));
-			return false;
-		}
-		m_pgnOut.setDevice(&m_pgnFile);
-	}
+	// The game writer serializes the game and keeps the games in
+	// order on its own thread
+	Chess::Result::Type type = pgn->result().type();
+	bool omit = !m_pgnWriteUnfinishedGames
+		&& (pgn->result().isNone() || (m_stopping && faulty(type)));
+	m_gameWriter->addGame(gameNumber, *pgn, whiteIndex, blackIndex,
+			      openingIndex, omit);
 
-	bool ok = true;
-	m_pgnGames[gameNumber] = *pgn;
-	while (m_pgnGames.contains(m_savedGameCount + 1))
-	{
-		PgnGame tmp = m_pgnGames.take(++m_savedGameCount);
-		Chess::Result::Type type = tmp.result().type();
-		if (!m_pgnWriteUnfinishedGames
-		&&  (tmp.result().isNone() || (m_stopping && faulty(type))))
-		{
-			qWarning("Omitted incomplete game %d", m_savedGameCount);
-			continue;
-		}
-		if (!tmp.write(m_pgnOut, m_pgnOutMode)
-		||  m_pgnFile.error() != QFile::NoError)
-		{
-			ok = false;
-			qWarning("Could not write PGN game %d", m_savedGameCount);
-		}
-	}
-
-	return ok;
+	// Failures of the earlier writes are reported here
+	return !m_gameWriter->hasError();
 }
 
 bool Tournament::writeEpd(ChessGame *game)
 {
 	Q_ASSERT(game != nullptr);
 
-	if (m_epdFile.fileName().isEmpty())
+	if (m_epdFileName.isEmpty())
 		return true;
 
-	bool isOpen = m_epdFile.isOpen();
-	if (!isOpen || !m_epdFile.exists())
-	{
-		if (isOpen)
-		{
-			qWarning("EPD file %s does not exist. Reopening...",
-				 qUtf8Printable(m_epdFile.fileName()));
-			m_epdFile.close();
-		}
-
-		if (!m_epdFile.open(QIODevice::WriteOnly | QIODevice::Append))
-		{
-			qWarning("Could not open EPD file %s",
-				 qUtf8Printable(m_epdFile.fileName()));
-			return false;
-		}
-		m_epdOut.setDevice(&m_epdFile);
-	}
-
-	const QString& epdPos = game->board()->fenString();
-	m_epdOut << epdPos << "\n";
-	m_epdOut.flush();
-	bool ok = true;
-	if (m_epdFile.error() != QFile::NoError)
-	{
-		ok = false;
-		qWarning("Could not write EPD position");
-	}
-
-	return ok;
+	m_gameWriter->addEpdPosition(game->board()->fenString());
+	return !m_gameWriter->hasError();
 }
 
 void Tournament::addScore(int player, Chess::Side side, int score)
@@ -722,6 +709,8 @@ void Tournament::onGameStarted(ChessGame* game)
 	int iBlack = data->blackIndex;
 	m_players[iWhite].setName(game->player(Chess::Side::White)->name());
 	m_players[iBlack].setName(game->player(Chess::Side::Black)->name());
+	updateRankingData(iWhite);
+	updateRankingData(iBlack);
 
 	emit gameStarted(game, data->number, iWhite, iBlack);
 }
@@ -778,9 +767,11 @@ void Tournament::onGameFinished(ChessGame* game)
 	}
 
 	writeEpd(game);
-	writePgn(pgn, gameNumber);
+	writePgn(pgn, gameNumber, iWhite, iBlack, data->openingIndex);
 
 	addOutcome(iWhite, iBlack, game->result());
+	updateRankingData(iWhite);
+	updateRankingData(iBlack);
 	Chess::Result::Type resultType(game->result().type());
 
 	bool crashed = (resultType == Chess::Result::Disconnection ||
@@ -788,11 +779,42 @@ void Tournament::onGameFinished(ChessGame* game)
 	if (!m_recover && crashed)
 		stop();
 
-	if (!m_sprt->isNull() && sprtResult != Sprt::NoResult)
+	if (!m_sprt->isNull())
 	{
-		m_sprt->addGameResult(sprtResult);
-		if (m_sprt->status().result != Sprt::Continue)
+		if (m_sprt->model() == Sprt::Pentanomial)
+		{
+			// Pair up consecutive repetitions of the same opening,
+			// which are played with reversed colors
+			const auto key = qMakePair(data->openingNumber,
+						   (data->repetition - 1) / 2);
+			auto it = m_sprtPairResults.find(key);
+			if (it == m_sprtPairResults.end())
+				m_sprtPairResults.insert(key, sprtResult);
+			else
+			{
+				m_sprt->addGamePairResult(it.value(), sprtResult);
+				m_sprtPairResults.erase(it);
+			}
+		}
+		else if (sprtResult != Sprt::NoResult)
+			m_sprt->addGameResult(sprtResult);
+
+		if (m_sprt->status().result == Sprt::Continue)
+		{
+			// The games that were still running brought the test
+			// back inside its bounds, or are no longer expected to
+			// conclude it, so more games are needed
+			if (m_sprtDraining && !m_stopping && !areAllGamesFinished()
+			&&  !isSprtExpectedToConclude())
+				resumeSprtDispatch();
+		}
+		else if (!m_sprtDrain)
 			QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
+		else if (!m_sprtDraining)
+		{
+			// Let the running games finish and count
+			pauseSprtDispatch();
+		}
 	}
 
 	emit gameFinished(game, gameNumber, iWhite, iBlack);
@@ -800,9 +822,11 @@ void Tournament::onGameFinished(ChessGame* game)
 	if (m_pgnCleanup)
 		delete pgn;
 
-	if (areAllGamesFinished() || (m_stopping && m_gameData.isEmpty()))
+	if (areAllGamesFinished()
+	||  ((m_stopping || m_sprtDraining) && m_gameData.isEmpty()))
 	{
 		m_stopping = false;
+		m_sprtDraining = false;
 		m_lastGame = game;
 		connect(m_gameManager, SIGNAL(gameDestroyed(ChessGame*)),
 			this, SLOT(onGameDestroyed(ChessGame*)));
@@ -812,6 +836,36 @@ void Tournament::onGameFinished(ChessGame* game)
 	game->deleteLater();
 }
 
+bool Tournament::isSprtExpectedToConclude() const
+{
+	if (!m_sprtDrain || m_sprt->isNull() || m_gameData.isEmpty())
+		return false;
+
+	// The results of the games in progress, and in pentanomial mode
+	// also the finished games that are still waiting for their pair
+	int pendingGames = m_gameData.size();
+	if (m_sprt->model() == Sprt::Pentanomial)
+		pendingGames += m_sprtPairResults.size();
+
+	return m_sprt->expectedResult(pendingGames) != Sprt::Continue;
+}
+
+void Tournament::pauseSprtDispatch()
+{
+	m_sprtDraining = true;
+	disconnect(m_gameManager, SIGNAL(ready()),
+		   this, SLOT(startNextGame()));
+}
+
+void Tournament::resumeSprtDispatch()
+{
+	m_sprtDraining = false;
+	connect(m_gameManager, SIGNAL(ready()),
+		this, SLOT(startNextGame()));
+	QMetaObject::invokeMethod(this, "startNextGame",
+				  Qt::QueuedConnection);
+}
+
 void Tournament::onGameDestroyed(ChessGame* game)
 {
 	if (game != m_lastGame)
@@ -834,6 +888,9 @@ void Tournament::onGameStartFailed(ChessGame* game)
 
 void Tournament::onFinished()
 {
+	// Make sure the output files are complete when the
+	// tournament is reported as finished
+	m_gameWriter->flush();
 	m_gameManager->cleanupIdleThreads();
 	m_finished = true;
 	emit finished();
@@ -846,17 +903,21 @@ void Tournament::start()
 	m_round = 1;
 	m_nextGameNumber = 0;
 	m_finishedGameCount = 0;
-	m_savedGameCount = 0;
 	m_finalGameCount = 0;
 	m_stopping = false;
+	m_sprtDraining = false;
 
 	if (m_openingPolicy == EncounterPolicy || m_openingPolicy == RoundPolicy)
 		setOpeningRepetitions(INT_MAX);
 
 	m_gameData.clear();
-	m_pgnGames.clear();
+	m_sprtPairResults.clear();
+	m_openingCount = 0;
+	m_openingIndex = -1;
+	m_gameWriter->reset();
 	m_startFen.clear();
 	m_openingMoves.clear();
+	m_repeatOpening = false;
 
 	connect(m_gameManager, SIGNAL(ready()),
 		this, SLOT(startNextGame()));
@@ -901,37 +962,128 @@ int Tournament::gameNumber(ChessGame* game) const
 }
 
 
-QString Tournament::resultsForSides(int index) const
+void Tournament::updateRankingData(int index)
+{
+	const TournamentPlayer& player(playerAt(index));
+	Elo elo(player.wins(), player.losses(), player.draws());
+	Elo whiteElo(player.whiteWins(),
+		     player.whiteLosses(),
+		     player.whiteDraws());
+	Elo blackElo(player.blackWins(),
+		     player.blackLosses(),
+		     player.blackDraws());
+
+	m_rankingData[index] = { player.name(),
+				 player.gamesFinished(),
+				 player.wins(),
+				 player.losses(),
+				 player.draws(),
+				 player.whiteWins(),
+				 player.whiteLosses(),
+				 player.whiteDraws(),
+				 player.blackWins(),
+				 player.blackLosses(),
+				 player.blackDraws(),
+				 player.score() / 2.,
+				 elo.pointRatio(),
+				 elo.drawRatio(),
+				 elo.diff(),
+				 elo.errorMargin(),
+				 elo.LOS(),
+				 whiteElo.pointRatio(),
+				 whiteElo.drawRatio(),
+				 whiteElo.diff(),
+				 whiteElo.errorMargin(),
+				 whiteElo.LOS(),
+				 blackElo.pointRatio(),
+				 blackElo.drawRatio(),
+				 blackElo.diff(),
+				 blackElo.errorMargin(),
+				 blackElo.LOS(),
+				 player.outcomes(Chess::Result::Timeout),
+				 player.outcomes(Chess::Result::IllegalMove),
+				 player.outcomes(Chess::Result::Disconnection),
+				 player.outcomes(Chess::Result::StalledConnection),
+				 player.outcomes(AuxResultType::InvalidResultClaim),
+				 player.outcomes(AuxResultType::RegularLoss),
+				 player.outcomes(AuxResultType::RegularWin),
+				 player.outcomes(AuxResultType::OtherWin),
+				 player.outcomes(AuxResultType::Stalemate),
+				 player.outcomes(AuxResultType::InsufficientMaterial),
+				 player.outcomes(AuxResultType::MoveRepetiton),
+				 player.outcomes(AuxResultType::MovesRule),
+				 player.outcomes(AuxResultType::CountingRules),
+				 player.outcomes(Chess::Result::Adjudication),
+				 player.outcomes(Chess::Result::Agreement),
+				 player.outcomes(AuxResultType::OtherDraw),
+				 player.timeControl().toString() };
+}
+
+QString Tournament::results() const
+{
+	return standings().toString();
+}
+
+Tournament::Standings Tournament::standings() const
+{
+	Standings standings;
+	standings.m_players = m_rankingData;
+
+	//First assign raw format string, then try to find named format
+	standings.m_format = m_resultFormat;
+	if (m_namedFormats.contains(m_resultFormat))
+		standings.m_format = m_namedFormats[m_resultFormat];
+
+	for (auto it = m_namedGroups.cbegin(); it != m_namedGroups.cend(); it++)
+		standings.m_format.replace(it.key(), it.value());
+
+	standings.m_tokenMap = m_tokenMap;
+	standings.m_headerMap = m_headerMap;
+	standings.m_seedCount = seedCount();
+	standings.m_gauntletOrder = hasGauntletRatingsOrder();
+	standings.m_sprtStatus = m_sprt->status();
+
+	return standings;
+}
+
+Tournament::Standings::Standings(const QString& text)
+	: m_text(text),
+	  m_seedCount(0),
+	  m_gauntletOrder(false),
+	  m_sprtStatus({Sprt::Continue, 0.0, 0.0, 0.0})
+{
+}
+
+QString Tournament::Standings::resultsForSides(const RankingData& data)
 {
 	QString ret;
-	TournamentPlayer player = playerAt(index);
-	int gamesWithWhite  = player.whiteWins() + player.whiteDraws()
-			    + player.whiteLosses();
-	int whiteScore  = 2 * player.whiteWins() + player.whiteDraws();
-	int games = player.gamesFinished();
+	int gamesWithWhite  = data.whiteWins + data.whiteDraws
+			    + data.whiteLosses;
+	int whiteScore  = 2 * data.whiteWins + data.whiteDraws;
+	int games = data.games;
 
 	if (gamesWithWhite > 0)
 	{
 		ret += tr("...      %1 playing White: %2 - %3 - %4  [%5] %6\n")
-		.arg(qUtf8Printable(player.name()))
-		.arg(player.whiteWins())
-		.arg(player.whiteLosses())
-		.arg(player.whiteDraws())
+		.arg(qUtf8Printable(data.name))
+		.arg(data.whiteWins)
+		.arg(data.whiteLosses)
+		.arg(data.whiteDraws)
 		.arg(double(whiteScore) / (gamesWithWhite * 2), 0, 'f', 3)
 		.arg(gamesWithWhite);
 	}
 
-	int gamesWithBlack  = player.blackWins() + player.blackDraws()
-			    + player.blackLosses();
-	int blackScore  = 2 * player.blackWins() + player.blackDraws();
+	int gamesWithBlack  = data.blackWins + data.blackDraws
+			    + data.blackLosses;
+	int blackScore  = 2 * data.blackWins + data.blackDraws;
 
 	if (gamesWithBlack > 0)
 	{
 		ret += tr("...      %1 playing Black: %2 - %3 - %4  [%5] %6\n")
-		.arg(qUtf8Printable(player.name()))
-		.arg(player.blackWins())
-		.arg(player.blackLosses())
-		.arg(player.blackDraws())
+		.arg(qUtf8Printable(data.name))
+		.arg(data.blackWins)
+		.arg(data.blackLosses)
+		.arg(data.blackDraws)
 		.arg(double(blackScore) / (gamesWithBlack * 2), 0, 'f', 3)
 		.arg(gamesWithBlack);
 	}
@@ -939,9 +1091,9 @@ QString Tournament::resultsForSides(int index) const
 	if (games > 0)
 	{
 		ret += tr("...      White vs Black: %1 - %2 - %3  [%4] %5\n")
-		.arg(player.whiteWins() + player.blackLosses())
-		.arg(player.whiteLosses() + player.blackWins())
-		.arg(player.draws())
+		.arg(data.whiteWins + data.blackLosses)
+		.arg(data.whiteLosses + data.blackWins)
+		.arg(data.draws)
 		.arg(double(whiteScore + 2 * gamesWithBlack - blackScore)
 			    / (games * 2), 0, 'f', 3)
 		.arg(games);
@@ -949,84 +1101,35 @@ QString Tournament::resultsForSides(int index) const
 	return ret;
 }
 
-QString Tournament::results() const
+QString Tournament::Standings::toString() const
 {
+	if (m_players.isEmpty())
+		return m_text;
+
 	QMultiMap<qreal, RankingData> ranking;
 	QString ret;
 
-	for (int i = 0; i < playerCount(); i++)
+	for (int i = 0; i < m_players.size(); i++)
 	{
-		const TournamentPlayer& player(playerAt(i));
-		Elo elo(player.wins(), player.losses(), player.draws());
-		Elo whiteElo(player.whiteWins(),
-			     player.whiteLosses(),
-			     player.whiteDraws());
-		Elo blackElo(player.blackWins(),
-			     player.blackLosses(),
-			     player.blackDraws());
-
-		if (playerCount() == 2)
+		const RankingData& data = m_players.at(i);
+
+		if (m_players.size() == 2)
 		{
-			ret += resultsForSides(0);
+			ret += resultsForSides(data);
 			ret += QString("Elo difference: %1 +/- %2, LOS: %3 %, DrawRatio: %4 %")
-				.arg(elo.diff(), 0, 'f', 1)
-				.arg(elo.errorMargin(), 0, 'f', 1)
-				.arg(elo.LOS(), 0, 'f', 1)
-				.arg(elo.drawRatio() * 100, 0, 'f', 1);
+				.arg(data.eloDiff, 0, 'f', 1)
+				.arg(data.errorMargin, 0, 'f', 1)
+				.arg(data.LOS, 0, 'f', 1)
+				.arg(data.drawScore * 100, 0, 'f', 1);
 			break;
 		}
 
-		RankingData data = { player.name(),
-				     player.gamesFinished(),
-				     player.wins(),
-				     player.losses(),
-				     player.draws(),
-				     player.whiteWins(),
-				     player.whiteLosses(),
-				     player.whiteDraws(),
-				     player.blackWins(),
-				     player.blackLosses(),
-				     player.blackDraws(),
-				     player.score() / 2.,
-				     elo.pointRatio(),
-				     elo.drawRatio(),
-				     elo.diff(),
-				     elo.errorMargin(),
-				     elo.LOS(),
-				     whiteElo.pointRatio(),
-				     whiteElo.drawRatio(),
-				     whiteElo.diff(),
-				     whiteElo.errorMargin(),
-				     whiteElo.LOS(),
-				     blackElo.pointRatio(),
-				     blackElo.drawRatio(),
-				     blackElo.diff(),
-				     blackElo.errorMargin(),
-				     blackElo.LOS(),
-				     player.outcomes(Chess::Result::Timeout),
-				     player.outcomes(Chess::Result::IllegalMove),
-				     player.outcomes(Chess::Result::Disconnection),
-				     player.outcomes(Chess::Result::StalledConnection),
-				     player.outcomes(AuxResultType::InvalidResultClaim),
-				     player.outcomes(AuxResultType::RegularLoss),
-				     player.outcomes(AuxResultType::RegularWin),
-				     player.outcomes(AuxResultType::OtherWin),
-				     player.outcomes(AuxResultType::Stalemate),
-				     player.outcomes(AuxResultType::InsufficientMaterial),
-				     player.outcomes(AuxResultType::MoveRepetiton),
-				     player.outcomes(AuxResultType::MovesRule),
-				     player.outcomes(AuxResultType::CountingRules),
-				     player.outcomes(Chess::Result::Adjudication),
-				     player.outcomes(Chess::Result::Agreement),
-				     player.outcomes(AuxResultType::OtherDraw),
-				     player.timeControl().toString() };
-
 		// Order players like this:
 		// 1. Gauntlet player (if any)
 		// 2. Players with finished games, sorted by point ratio
 		// 3. Players without finished games
 		qreal key = -1.0;
-		if ((i > 0 && i >= seedCount()) || !hasGauntletRatingsOrder())
+		if ((i > 0 && i >= m_seedCount) || !m_gauntletOrder)
 		{
 			if (data.games)
 				key = 1.0 - data.score;
@@ -1036,20 +1139,12 @@ QString Tournament::results() const
 		ranking.insert(key, data);
 	}
 
-	//First assign raw format string, then try to find named format
-	QString format = m_resultFormat;
-	if (m_namedFormats.contains(m_resultFormat))
-		format = m_namedFormats[m_resultFormat];
-
-	for (auto it = m_namedGroups.cbegin(); it != m_namedGroups.cend(); it++)
-		format.replace(it.key(), it.value());
-
-	ResultFormatter formatter(m_tokenMap, format);
+	ResultFormatter formatter(m_tokenMap, m_format);
 
 	if (!ranking.isEmpty())
 		ret += formatter.entry(m_headerMap);
 
-	int rank = hasGauntletRatingsOrder() ? -1 : 0;
+	int rank = m_gauntletOrder ? -1 : 0;
 	for (auto it = ranking.constBegin(); it != ranking.constEnd(); ++it)
 	{
 		const RankingData& data = it.value();
@@ -1102,7 +1197,7 @@ QString Tournament::results() const
 		ret += formatter.entry(dataMap);
 	}
 
-	Sprt::Status sprtStatus = sprt()->status();
+	const Sprt::Status& sprtStatus = m_sprtStatus;
 	if (sprtStatus.llr != 0.0
 	||  sprtStatus.lBound != 0.0
 	||  sprtStatus.uBound != 0.0)
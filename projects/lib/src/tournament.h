@@ -23,20 +23,19 @@
 #include <QList>
 #include <QVector>
 #include <QMap>
-#include <QFile>
-#include <QTextStream>
 #include "board/move.h"
 #include "timecontrol.h"
 #include "pgngame.h"
 #include "gameadjudicator.h"
 #include "tournamentplayer.h"
 #include "tournamentpair.h"
+#include "sprt.h"
 class GameManager;
 class PlayerBuilder;
 class ChessGame;
 class OpeningBook;
 class OpeningSuite;
-class Sprt;
+class GameWriter;
 
 /*!
  * \brief Base class for chess tournaments
@@ -148,6 +147,22 @@ class LIB_EXPORT Tournament : public QObject
 		 * stopping criterion.
 		 */
 		Sprt* sprt() const;
+		/*!
+		 * Sets SPRT drain mode to \a enabled.
+		 *
+		 * If \a enabled is true, a concluded SPRT doesn't stop the
+		 * games in progress. No new games are started, and the running
+		 * games are played to the end and added to the test. If they
+		 * bring the test back inside its bounds, new games are started
+		 * again. The default is false.
+		 *
+		 * In drain mode new games are also held back while the games
+		 * in progress are expected to conclude the test on their own,
+		 * judging by the trajectory of the log-likelihood ratio.
+		 *
+		 * \sa Sprt::expectedResult()
+		 */
+		void setSprtDrainEnabled(bool enabled);
 
 		/*! Sets the tournament's name to \a name. */
 		void setName(const QString& name);
@@ -225,6 +240,16 @@ class LIB_EXPORT Tournament : public QObject
 		 * objects are destroyed automatically once the games are finished.
 		 */
 		void setPgnCleanupEnabled(bool enabled);
+		/*!
+		 * Sets lazy SAN generation to \a enabled.
+		 *
+		 * If \a enabled is true the games store only the moves while
+		 * they are played, and the SAN strings and the opening are
+		 * generated in one pass when a game ends. This saves work
+		 * between moves when the move strings aren't displayed.
+		 * The default is false.
+		 */
+		void setLazySan(bool enabled);
 
 		/*!
 		 * Sets the EPD output file for the end positions to \a fileName.
@@ -234,6 +259,19 @@ class LIB_EXPORT Tournament : public QObject
 		 */
 		void setEpdOutput(const QString& fileName);
 
+		/*!
+		 * Sets the binary game log file to \a fileName.
+		 *
+		 * The games are appended to the file as compact binary
+		 * records that can be converted back to PGN. If
+		 * \a evaluations is true, the evaluation and time of each
+		 * move are also stored. If no binary output file is set
+		 * (default) then no binary log is written.
+		 *
+		 * \sa BinaryGameLog
+		 */
+		void setBinaryOutput(const QString& fileName, bool evaluations);
+
 		/*!
 		 * Sets the number of opening repetitions to \a count.
 		 *
@@ -254,6 +292,17 @@ class LIB_EXPORT Tournament : public QObject
 		 * only when a new round starts.
 		 */
 		void setOpeningPolicy(OpeningPolicy policy = DefaultPolicy);
+		/*!
+		 * Returns true if the games are played in pairs that
+		 * share an opening and reverse the colors of the players.
+		 *
+		 * This requires an even number of opening repetitions (or
+		 * an opening policy other than \ref DefaultPolicy), an even
+		 * number of games per encounter, and swapped sides.
+		 *
+		 * \sa Sprt::Pentanomial
+		 */
+		bool playsGamePairs() const;
 		/*!
 		 * Sets the reverse colors flag to \a enabled.
 		 *
@@ -317,11 +366,25 @@ class LIB_EXPORT Tournament : public QObject
 			       const TimeControl& timeControl,
 			       const OpeningBook* book = nullptr,
 			       int bookDepth = 256);
+		class Standings;
+
 		/*!
 		 * Returns tournament results as a string.
 		 * The default implementation works for most tournament types.
 		 */
 		virtual QString results() const;
+		/*!
+		 * Returns a snapshot of the tournament results.
+		 *
+		 * The player statistics are updated as each game finishes,
+		 * so taking a snapshot is cheap. The snapshot can be
+		 * formatted with Standings::toString() on any thread.
+		 *
+		 * The default implementation works for most tournament
+		 * types. Tournaments that reimplement results() should
+		 * return their results as preformatted text.
+		 */
+		virtual Standings standings() const;
 		/*!
 		 * Returns outcome statistics per player as a string.
 		 */
@@ -502,7 +565,11 @@ class LIB_EXPORT Tournament : public QObject
 
 	private slots:
 		void startNextGame();
-		bool writePgn(PgnGame* pgn, int gameNumber);
+		bool writePgn(PgnGame* pgn,
+			      int gameNumber,
+			      int whiteIndex,
+			      int blackIndex,
+			      int openingIndex);
 		bool writeEpd(ChessGame* game);
 		void onGameStarted(ChessGame* game);
 		void onGameFinished(ChessGame* game);
@@ -642,6 +709,9 @@ class LIB_EXPORT Tournament : public QObject
 			int number;
 			int whiteIndex;
 			int blackIndex;
+			int openingNumber;
+			int openingIndex;
+			int repetition;
 		};
 		struct RankingData
 		{
@@ -691,7 +761,10 @@ class LIB_EXPORT Tournament : public QObject
 			QString timeControl;
 		};
 
-		QString resultsForSides(int index) const;
+		void updateRankingData(int index);
+		bool isSprtExpectedToConclude() const;
+		void pauseSprtDispatch();
+		void resumeSprtDispatch();
 
 		GameManager* m_gameManager;
 		ChessGame* m_lastGame;
@@ -703,7 +776,6 @@ class LIB_EXPORT Tournament : public QObject
 		int m_oldRound;
 		int m_nextGameNumber;
 		int m_finishedGameCount;
-		int m_savedGameCount;
 		int m_finalGameCount;
 		int m_gamesPerEncounter;
 		int m_roundMultiplier;
@@ -711,36 +783,76 @@ class LIB_EXPORT Tournament : public QObject
 		int m_openingDepth;
 		int m_seedCount;
 		bool m_stopping;
+		bool m_sprtDrain;
+		bool m_sprtDraining;
 		int m_openingRepetitions;
 		OpeningPolicy m_openingPolicy;
 		bool m_recover;
 		bool m_pgnCleanup;
+		bool m_lazySan;
 		bool m_pgnWriteUnfinishedGames;
 		bool m_finished;
 		bool m_bookOwnership;
 		GameAdjudicator m_adjudicator;
 		OpeningSuite* m_openingSuite;
 		Sprt* m_sprt;
-		QFile m_pgnFile;
-		QTextStream m_pgnOut;
-		QFile m_epdFile;
-		QTextStream m_epdOut;
+		GameWriter* m_gameWriter;
+		QString m_pgnFileName;
+		QString m_epdFileName;
+		QString m_binaryFileName;
 		QString m_startFen;
+		bool m_repeatOpening;
 		int m_repetitionCounter;
+		int m_openingCount;
+		int m_openingIndex;
 		int m_swapSides;
 		bool m_reverseSides;
 
 		QString m_resultFormat;
-		PgnGame::PgnMode m_pgnOutMode;
 		TournamentPair* m_pair;
 		QMap< QPair<int, int>, TournamentPair* > m_pairs;
 		QList<TournamentPlayer> m_players;
-		QMap<int, PgnGame> m_pgnGames;
+		QVector<RankingData> m_rankingData;
 		QMap<ChessGame*, GameData*> m_gameData;
+		QMap<QPair<int, int>, Sprt::GameResult> m_sprtPairResults;
 		QVector<Chess::Move> m_openingMoves;
 		QMap<int, QString> m_headerMap;
 };
 
+/*!
+ * \brief A snapshot of tournament results
+ *
+ * Standings holds a copy of the player statistics of a Tournament at
+ * one point in time. It doesn't refer back to the tournament, so it
+ * can be formatted on another thread while the games go on.
+ */
+class LIB_EXPORT Tournament::Standings
+{
+	public:
+		/*!
+		 * Creates a new Standings object with the preformatted
+		 * results \a text.
+		 */
+		explicit Standings(const QString& text = QString());
+
+		/*! Returns the results as a string. */
+		QString toString() const;
+
+	private:
+		friend class Tournament;
+
+		static QString resultsForSides(const RankingData& data);
+
+		QString m_text;
+		QVector<RankingData> m_players;
+		QString m_format;
+		QMap<QString, int> m_tokenMap;
+		QMap<int, QString> m_headerMap;
+		int m_seedCount;
+		bool m_gauntletOrder;
+		Sprt::Status m_sprtStatus;
+};
+
 /*!
  * \brief Formatter for chess tournament results
  */
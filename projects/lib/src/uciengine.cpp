@@ -17,6 +17,7 @@
 
 #include "uciengine.h"
 
+#include <QMetaMethod>
 #include <QString>
 #include <QStringList>
 
@@ -87,6 +88,7 @@ QStringView joinTokens(const QVarLengthArray<QStringView>& tokens)
 UciEngine::UciEngine(QObject* parent)
 	: ChessEngine(parent),
 	  m_useDirectPv(false),
+	  m_currentEvalPvIsLan(false),
 	  m_sendOpponentsName(false),
 	  m_canPonder(false),
 	  m_ponderState(NotPondering),
@@ -234,6 +236,9 @@ void UciEngine::makeBookMove(const Chess::Move& move)
 
 void UciEngine::startThinking()
 {
+	// The evaluation was cleared when the clock was started
+	clearLanPvs();
+
 	if (m_ponderState == PonderHit)
 	{
 		m_ponderState = NotPondering;
@@ -309,6 +314,41 @@ void UciEngine::clearPonderState()
 	m_ponderMoveSan.clear();
 }
 
+void UciEngine::convertLanPvs()
+{
+	// The PVs are in the context of the current position
+	// until the engine's move is made
+	if (!m_lanPv.isEmpty())
+		m_eval.setPv(sanPv(m_lanPv));
+	for (int i = 0; i < m_eval.pvLineCount(); i++)
+	{
+		const QString& lanPv = m_lanPvLines[i];
+		if (lanPv.isEmpty())
+			continue;
+
+		// Engines that always send "multipv 1" repeat the main
+		// PV as the first line, so its conversion can be shared
+		const MoveEvaluation::PvLine& line = m_eval.pvLine(i);
+		const QString pv = (lanPv == m_lanPv) ? m_eval.pv() : sanPv(lanPv);
+		m_eval.setPvLine(i + 1, line.depth, line.score, pv);
+	}
+	clearLanPvs();
+}
+
+void UciEngine::clearLanPvs()
+{
+	m_lanPv.clear();
+	for (QString& lanPv : m_lanPvLines)
+		lanPv.clear();
+}
+
+bool UciEngine::hasThinkingListeners() const
+{
+	static const QMetaMethod signal =
+		QMetaMethod::fromSignal(&ChessPlayer::thinking);
+	return isSignalConnected(signal);
+}
+
 bool UciEngine::isPondering() const
 {
 	return (m_ponderState != NotPondering);
@@ -401,22 +441,25 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringView>& tokens,
 	switch (type)
 	{
 	case InfoDepth:
-		eval->setDepth(tokens[0].toString().toInt());
+		eval->setDepth(tokens[0].toInt());
 		break;
 	case InfoSelDepth:
-		eval->setSelectiveDepth(tokens[0].toString().toInt());
+		eval->setSelectiveDepth(tokens[0].toInt());
 		break;
 	case InfoTime:
-		eval->setTime(tokens[0].toString().toInt());
+		eval->setTime(tokens[0].toInt());
 		break;
 	case InfoNodes:
-		eval->setNodeCount(tokens[0].toString().toULongLong());
+		eval->setNodeCount(tokens[0].toULongLong());
 		break;
 	case InfoMultiPv:
-		eval->setPvNumber(tokens[0].toString().toInt());
+		eval->setPvNumber(tokens[0].toInt());
 		break;
 	case InfoPv:
-		eval->setPv(m_useDirectPv ?  directPv(tokens) : sanPv(tokens));
+		// The PV is stored as sent by the engine. Converting it to
+		// SAN is left to the consumer because it's costly and most
+		// PVs are discarded before anyone reads them.
+		eval->setPv(joinTokens(tokens).toString());
 		break;
 	case InfoScore:
 		{
@@ -424,10 +467,10 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringView>& tokens,
 			for (int i = 1; i < tokens.size(); i++)
 			{
 				if (tokens[i - 1] == QLatin1String("cp"))
-					score = tokens[i].toString().toInt();
+					score = tokens[i].toInt();
 				else if (tokens[i - 1] == QLatin1String("mate"))
 				{
-					score = tokens[i].toString().toInt();
+					score = tokens[i].toInt();
 					if (score > 0)
 						score = eval->MATE_SCORE + 1 - score * 2;
 					else if (score < 0)
@@ -444,13 +487,13 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringView>& tokens,
 		}
 		break;
 	case InfoNps:
-		eval->setNps(tokens[0].toString().toULongLong());
+		eval->setNps(tokens[0].toULongLong());
 		break;
 	case InfoTbHits:
-		eval->setTbHits(tokens[0].toString().toULongLong());
+		eval->setTbHits(tokens[0].toULongLong());
 		break;
 	case InfoHashFull:
-		eval->setHashUsage(tokens[0].toString().toInt());
+		eval->setHashUsage(tokens[0].toInt());
 		break;
 	default:
 		break;
@@ -607,13 +650,53 @@ void UciEngine::parseLine(const QString& line)
 		if (m_movesPondered)
 			eval.setPonderhitRate((m_ponderHits * 1000) / m_movesPondered);
 
+		// The PV is only converted to SAN here if someone is
+		// listening, so every eval that reaches a listener has a
+		// SAN PV. Otherwise the final eval gets its PVs when the
+		// engine sends "bestmove", and until then it has none.
+		bool lanPv = !eval.pv().isEmpty() && !m_useDirectPv;
+		if (lanPv && hasThinkingListeners())
+		{
+			eval.setPv(sanPv(eval.pv()));
+			lanPv = false;
+		}
+
+		// Keep every line of a MultiPV search in the final eval
+		const int pvNumber = eval.pvNumber();
+		if (pvNumber >= 1 && pvNumber <= MoveEvaluation::MAX_PV_LINES
+		&&  !eval.pv().isEmpty())
+		{
+			m_lanPvLines[pvNumber - 1] = lanPv ? eval.pv() : QString();
+			m_eval.setPvLine(pvNumber, eval.depth(), eval.score(),
+					 lanPv ? QString() : eval.pv());
+		}
+
 		// Only the primary PV can be considered the current eval
 		if (eval.pvNumber() <= 1)
 		{
 			m_eval.merge(eval);
+			if (lanPv)
+			{
+				m_lanPv = eval.pv();
+				m_eval.setPv(QString());
+			}
+			else if (!eval.pv().isEmpty())
+				m_lanPv.clear();
 			if (eval.depth() && eval.depth() != m_currentEval.depth())
+			{
 				m_currentEval.clear();
+				m_currentEvalPvIsLan = false;
+			}
 			m_currentEval.merge(eval);
+			if (!eval.pv().isEmpty())
+				m_currentEvalPvIsLan = lanPv;
+
+			// A listener may have connected after the PV was stored
+			if (m_currentEvalPvIsLan && hasThinkingListeners())
+			{
+				m_currentEval.setPv(sanPv(m_currentEval.pv()));
+				m_currentEvalPvIsLan = false;
+			}
 
 			emit thinking(m_currentEval);
 		}
@@ -658,6 +741,9 @@ void UciEngine::parseLine(const QString& line)
 			return;
 		}
 
+		// Convert the PVs before the ponder move changes their context
+		convertLanPvs();
+
 		auto bestmove = tokenize(args);
 		QString moveString(bestmove.first.toString());
 		m_moveStrings += " " + moveString;
@@ -818,18 +904,7 @@ void UciEngine::setPonderMove(const QString& moveString)
 	}
 }
 
-QString UciEngine::directPv(const QVarLengthArray<QStringView>& tokens)
-{
-	QString pv;
-	for( auto token : tokens)
-	{
-		pv += " ";
-		pv += token.toString();
-	}
-	return pv;
-}
-
-QString UciEngine::sanPv(const QVarLengthArray<QStringView>& tokens)
+QString UciEngine::sanPv(QStringView lanPv)
 {
 	Chess::Board* board = this->board();
 	QString pv;
@@ -841,12 +916,18 @@ QString UciEngine::sanPv(const QVarLengthArray<QStringView>& tokens)
 		movesMade++;
 	}
 
-	for (auto token : tokens)
+	QStringView remaining(lanPv);
+	while (!remaining.isEmpty())
 	{
-		auto move = board->moveFromString(token.toString());
+		auto split = tokenize(remaining);
+		remaining = split.second;
+		if (split.first.isEmpty())
+			break;
+
+		QString tokenString(split.first.toString());
+		auto move = board->moveFromString(tokenString);
 		if (move.isNull())
 		{
-			QString tokenString(token.toString());
 			qWarning("Illegal PV move %s from %s (%d)",
 				 qUtf8Printable(tokenString),
 				 qUtf8Printable(name()),
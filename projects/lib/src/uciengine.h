@@ -67,8 +67,11 @@ class LIB_EXPORT UciEngine : public ChessEngine
 			       MoveEvaluation* eval);
 		MoveEvaluation parseInfo(QStringView line);
 		EngineOption* parseOption(QStringView line);
-		QString directPv(const QVarLengthArray<QStringView>& tokens);
-		QString sanPv(const QVarLengthArray<QStringView>& tokens);
+		/*!
+		 * Converts the long algebraic \a lanPv received from the
+		 * engine into SAN in the context of the current position.
+		 */
+		QString sanPv(QStringView lanPv);
 
 	private:
 		enum PonderState
@@ -83,11 +86,24 @@ class LIB_EXPORT UciEngine : public ChessEngine
 		QString positionString();
 		void sendPosition();
 		void setPonderMove(const QString& moveString);
+		bool hasThinkingListeners() const;
+		// Converts the pending PVs of the final eval to SAN
+		void convertLanPvs();
+		void clearLanPvs();
 
 		QString m_variantOption;
 		QString m_startFen;
 		QString m_moveStrings;
 		bool m_useDirectPv;
+		// The PV of the final eval (m_eval) as sent by the engine,
+		// if it hasn't been converted to SAN yet
+		QString m_lanPv;
+		// The PVs of the MultiPV lines that haven't been converted
+		// to SAN yet, or empty strings
+		QString m_lanPvLines[MoveEvaluation::MAX_PV_LINES];
+		// True if the PV of m_currentEval hasn't been converted
+		// to SAN yet
+		bool m_currentEvalPvIsLan;
 		// Write buffer for messages that will be flushed to the engine
 		// after it sends a "bestmove"
 		QStringList m_bmBuffer;
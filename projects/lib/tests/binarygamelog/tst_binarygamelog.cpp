@@ -0,0 +1,267 @@
+#include <QtTest/QTest>
+#include <QBuffer>
+#include <QFile>
+#include <QMap>
+#include <QTemporaryDir>
+#include <binarygamelog.h>
+#include <gamewriter.h>
+#include <pgngame.h>
+#include <pgnstream.h>
+
+
+class tst_BinaryGameLog: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void roundTrip_data() const;
+		void roundTrip();
+		void appendedSession();
+		void reopenedFile();
+
+	private:
+		PgnGame parseGame(const QByteArray& text) const;
+		QMap<QString, QString> tagMap(const PgnGame& game) const;
+};
+
+
+PgnGame tst_BinaryGameLog::parseGame(const QByteArray& text) const
+{
+	PgnStream stream(&text);
+	PgnGame game;
+	game.read(stream);
+	return game;
+}
+
+QMap<QString, QString> tst_BinaryGameLog::tagMap(const PgnGame& game) const
+{
+	QMap<QString, QString> tags;
+	const auto gameTags = game.tags();
+	for (const auto& tag : gameTags)
+		tags.insert(tag.first, tag.second);
+	return tags;
+}
+
+void tst_BinaryGameLog::roundTrip_data() const
+{
+	QTest::addColumn<QByteArray>("pgn");
+	QTest::addColumn<bool>("evaluations");
+	QTest::addColumn<int>("openingIndex");
+	QTest::addColumn<QString>("description");
+
+	QTest::newRow("standard evals")
+		<< QByteArray(
+		   "[Event \"Test\"]\n"
+		   "[White \"Engine A\"]\n"
+		   "[Black \"Engine B\"]\n"
+		   "[Result \"1-0\"]\n\n"
+		   "1. e4 {book} e5 {book} 2. Bc4 {+0.35/12 1.5s} "
+		   "Nc6 {-0.20/14 0.25s} 3. Qh5 {+M3/20 33s} "
+		   "Nf6 {-M2/18 0.015s} 4. Qxf7# {+M1/5 0.10s, White mates} "
+		   "1-0\n")
+		<< true << 5 << QString("White mates");
+	QTest::newRow("standard no evals")
+		<< QByteArray(
+		   "[Event \"Test\"]\n"
+		   "[White \"Engine A\"]\n"
+		   "[Black \"Engine B\"]\n"
+		   "[Result \"1-0\"]\n\n"
+		   "1. e4 {book} e5 {book} 2. Bc4 {+0.35/12 1.5s} "
+		   "Nc6 {-0.20/14 0.25s} 3. Qh5 {+M3/20 33s} "
+		   "Nf6 {-M2/18 0.015s} 4. Qxf7# {+M1/5 0.10s, White mates} "
+		   "1-0\n")
+		<< false << 0 << QString("White mates");
+	QTest::newRow("fen start")
+		<< QByteArray(
+		   "[White \"Engine A\"]\n"
+		   "[Black \"Engine B\"]\n"
+		   "[Result \"1/2-1/2\"]\n"
+		   "[SetUp \"1\"]\n"
+		   "[FEN \"4k3/8/8/8/8/8/4P3/4K3 b - - 0 1\"]\n\n"
+		   "1... Kd7 {-1.50/30 2.0s} 2. e4 {+1.50/31 1.0s} "
+		   "Ke6 {0.00/32 1.0s, Draw by adjudication} 1/2-1/2\n")
+		<< true << -1 << QString("Draw by adjudication");
+	QTest::newRow("wide moves")
+		<< QByteArray(
+		   "[Variant \"capablanca\"]\n"
+		   "[White \"Engine A\"]\n"
+		   "[Black \"Engine B\"]\n"
+		   "[Result \"*\"]\n\n"
+		   "1. j4 {+0.10/10 1.0s} j5 {-0.10/10 1.0s} "
+		   "2. Nh3 {+0.20/11 1.0s} Nh6 {-0.20/11 1.0s} *\n")
+		<< true << 12 << QString();
+	QTest::newRow("drops")
+		<< QByteArray(
+		   "[Variant \"crazyhouse\"]\n"
+		   "[White \"Engine A\"]\n"
+		   "[Black \"Engine B\"]\n"
+		   "[Result \"*\"]\n\n"
+		   "1. e4 d5 2. exd5 Qxd5 3. Nc3 Qd8 4. P@d5 P@e4 *\n")
+		<< false << 3 << QString();
+}
+
+void tst_BinaryGameLog::roundTrip()
+{
+	QFETCH(QByteArray, pgn);
+	QFETCH(bool, evaluations);
+	QFETCH(int, openingIndex);
+	QFETCH(QString, description);
+
+	const PgnGame game(parseGame(pgn));
+	QVERIFY(!game.moves().isEmpty());
+
+	QByteArray data;
+	QBuffer writeBuffer(&data);
+	QVERIFY(writeBuffer.open(QIODevice::WriteOnly));
+	BinaryGameLog writer(&writeBuffer);
+	QVERIFY(writer.writeHeader());
+	QVERIFY(writer.write(BinaryGameLog::encode(game, 0, 1,
+						   openingIndex,
+						   evaluations)));
+	writeBuffer.close();
+
+	QBuffer readBuffer(&data);
+	QVERIFY(readBuffer.open(QIODevice::ReadOnly));
+	BinaryGameLog reader(&readBuffer);
+	QVERIFY(reader.readHeader());
+
+	PgnGame result;
+	int index = 0;
+	QVERIFY(reader.read(&result, &index));
+	QVERIFY(reader.atEnd());
+
+	QCOMPARE(index, openingIndex);
+	QCOMPARE(tagMap(result), tagMap(game));
+	QCOMPARE(result.startingFenString(), game.startingFenString());
+	QCOMPARE(result.moves().size(), game.moves().size());
+
+	const int plyCount = game.moves().size();
+	for (int i = 0; i < plyCount; i++)
+	{
+		const PgnGame::MoveData& md = result.moves().at(i);
+		const PgnGame::MoveData& expected = game.moves().at(i);
+		QVERIFY(md.move == expected.move);
+		QCOMPARE(md.moveString, expected.moveString);
+		QCOMPARE(md.key, expected.key);
+
+		if (evaluations)
+			QCOMPARE(md.comment, expected.comment);
+		else if (i == plyCount - 1)
+			QCOMPARE(md.comment, description);
+		else
+			QVERIFY(md.comment.isEmpty());
+	}
+}
+
+void tst_BinaryGameLog::appendedSession()
+{
+	const PgnGame game1(parseGame(
+		"[Event \"Run 1\"]\n"
+		"[Variant \"crazyhouse\"]\n"
+		"[White \"Engine A\"]\n"
+		"[Black \"Engine B\"]\n"
+		"[Result \"*\"]\n\n"
+		"1. e4 d5 2. exd5 Qxd5 3. Nc3 Qd8 4. P@d5 P@e4 *\n"));
+	const PgnGame game2(parseGame(
+		"[Event \"Run 2\"]\n"
+		"[White \"Engine C\"]\n"
+		"[Black \"Engine D\"]\n"
+		"[Result \"1-0\"]\n\n"
+		"1. e4 e5 2. Bc4 Nc6 3. Qh5 Nf6 4. Qxf7# 1-0\n"));
+	QCOMPARE(game1.variant(), QString("crazyhouse"));
+	QCOMPARE(game2.variant(), QString("standard"));
+
+	// The second run appends to the log with a new writer that
+	// doesn't know the players and tags of the first run
+	QByteArray data;
+	{
+		QBuffer buffer(&data);
+		QVERIFY(buffer.open(QIODevice::WriteOnly));
+		BinaryGameLog writer(&buffer);
+		QVERIFY(writer.writeHeader());
+		QVERIFY(writer.write(BinaryGameLog::encode(game1, 0, 1, 0, false)));
+		QVERIFY(writer.write(BinaryGameLog::encode(game1, 1, 0, 0, false)));
+	}
+	{
+		QBuffer buffer(&data);
+		QVERIFY(buffer.open(QIODevice::WriteOnly | QIODevice::Append));
+		BinaryGameLog writer(&buffer);
+		QVERIFY(writer.write(BinaryGameLog::encode(game2, 0, 1, 1, false)));
+	}
+
+	QBuffer buffer(&data);
+	QVERIFY(buffer.open(QIODevice::ReadOnly));
+	BinaryGameLog reader(&buffer);
+	QVERIFY(reader.readHeader());
+
+	PgnGame game;
+	QVERIFY(reader.read(&game));
+	QCOMPARE(game.variant(), QString("crazyhouse"));
+	QCOMPARE(game.tagValue("Event"), QString("Run 1"));
+	QCOMPARE(game.moves().size(), game1.moves().size());
+
+	QVERIFY(reader.read(&game));
+	QCOMPARE(game.variant(), QString("crazyhouse"));
+	QCOMPARE(game.moves().size(), game1.moves().size());
+
+	QVERIFY(reader.read(&game));
+	QCOMPARE(game.variant(), QString("standard"));
+	QCOMPARE(game.tagValue("Event"), QString("Run 2"));
+	QCOMPARE(game.tagValue("Variant"), QString());
+	QCOMPARE(game.playerName(Chess::Side::White), QString("Engine C"));
+	QCOMPARE(game.playerName(Chess::Side::Black), QString("Engine D"));
+	QCOMPARE(tagMap(game), tagMap(game2));
+	QCOMPARE(game.moves().size(), game2.moves().size());
+	for (int i = 0; i < game.moves().size(); i++)
+		QCOMPARE(game.moves().at(i).moveString,
+			 game2.moves().at(i).moveString);
+
+	QVERIFY(reader.atEnd());
+	QVERIFY(!reader.read(&game));
+}
+
+void tst_BinaryGameLog::reopenedFile()
+{
+	const PgnGame game(parseGame(
+		"[Event \"Test\"]\n"
+		"[White \"Engine A\"]\n"
+		"[Black \"Engine B\"]\n"
+		"[Result \"1-0\"]\n\n"
+		"1. e4 e5 2. Bc4 Nc6 3. Qh5 Nf6 4. Qxf7# 1-0\n"));
+
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const QString fileName(dir.filePath("games.bin"));
+
+	GameWriter writer;
+	writer.setBinaryOutput(fileName, false);
+	writer.addGame(1, game, 0, 1, 0);
+	writer.flush();
+	QVERIFY(!writer.hasError());
+	QVERIFY(QFile::remove(fileName));
+
+	// The reopened file doesn't have the players and tags that
+	// were written before, so they're written again
+	const QString warning(QString("binary file %1 does not exist. "
+				      "Reopening...").arg(fileName));
+	QTest::ignoreMessage(QtWarningMsg, qUtf8Printable(warning));
+	writer.addGame(2, game, 0, 1, 1);
+	writer.flush();
+	QVERIFY(!writer.hasError());
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	BinaryGameLog reader(&file);
+	QVERIFY(reader.readHeader());
+
+	PgnGame result;
+	int openingIndex = -1;
+	QVERIFY(reader.read(&result, &openingIndex));
+	QCOMPARE(openingIndex, 1);
+	QCOMPARE(tagMap(result), tagMap(game));
+	QCOMPARE(result.moves().size(), game.moves().size());
+	QVERIFY(reader.atEnd());
+}
+
+QTEST_MAIN(tst_BinaryGameLog)
+#include "tst_binarygamelog.moc"
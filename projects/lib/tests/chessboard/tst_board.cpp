@@ -2,6 +2,31 @@
 #include <QtConcurrentRun>
 #include <board/board.h>
 #include <board/boardfactory.h>
+#include <board/standardboard.h>
+#include <board/frcboard.h>
+#include <board/crazyhouseboard.h>
+#include <board/loopboard.h>
+#include <board/kingofthehillboard.h>
+#include <board/ncheckboard.h>
+#include <board/hordeboard.h>
+#include <board/berolinaboard.h>
+#include <board/losersboard.h>
+#include <board/capablancaboard.h>
+#include <board/grandboard.h>
+#include <board/amazonboard.h>
+#include <board/chigorinboard.h>
+#include <board/hoppelpoppelboard.h>
+#include <board/losalamosboard.h>
+#include <board/pocketknightboard.h>
+#include <board/atomicboard.h>
+#include <board/almostboard.h>
+#include <board/chancellorboard.h>
+#include <board/gustavboard.h>
+#include <board/janusboard.h>
+#include <board/modernboard.h>
+#include <board/embassyboard.h>
+#include <board/gothicboard.h>
+#include <board/chessgiboard.h>
 
 
 class tst_Board: public QObject
@@ -18,6 +43,9 @@ class tst_Board: public QObject
 		void moveStrings_data() const;
 		void moveStrings();
 
+		void repetitions_data() const;
+		void repetitions();
+
 		void sanStrings_data() const;
 		void sanStrings();
 
@@ -27,10 +55,17 @@ class tst_Board: public QObject
 		void perft_data() const;
 		void perft();
 
+		void simpleLegality_data() const;
+		void simpleLegality();
+
+		void bitboards_data() const;
+		void bitboards();
+
 		void cleanupTestCase();
 	
 	private:
 		void setVariant(const QString& variant);
+		void legalityData(bool smallBoardsOnly) const;
 		Chess::Board* m_board;
 };
 
@@ -103,6 +138,136 @@ static quint64 smpPerft(Chess::Board* board, int depth)
 	return nodeCount;
 }
 
+/*
+ * A board that verifies every move by making it on the board,
+ * for comparison with WesternBoard's pin and check detection.
+ */
+template<class T>
+class ReferenceBoard : public T
+{
+	public:
+		virtual Chess::Board* copy() const
+		{
+			return new ReferenceBoard<T>(*this);
+		}
+
+	protected:
+		virtual bool hasSimpleLegality() const
+		{
+			return false;
+		}
+};
+
+/*
+ * A board that keeps no bitboards, for comparison with the bitboard
+ * move generation and attack detection of boards up to 8x8 squares.
+ */
+template<class T>
+class MailboxBoard : public T
+{
+	public:
+		virtual Chess::Board* copy() const
+		{
+			return new MailboxBoard<T>(*this);
+		}
+
+	protected:
+		virtual bool hasBitboards() const
+		{
+			return false;
+		}
+};
+
+template<template<class> class TestBoard>
+static Chess::Board* createTestBoard(const QString& variant)
+{
+	if (variant == "standard")
+		return new TestBoard<Chess::StandardBoard>();
+	if (variant == "fischerandom")
+		return new TestBoard<Chess::FrcBoard>();
+	if (variant == "crazyhouse")
+		return new TestBoard<Chess::CrazyhouseBoard>();
+	if (variant == "loop")
+		return new TestBoard<Chess::LoopBoard>();
+	if (variant == "kingofthehill")
+		return new TestBoard<Chess::KingOfTheHillBoard>();
+	if (variant == "3check")
+		return new TestBoard<Chess::ThreeCheckBoard>();
+	if (variant == "horde")
+		return new TestBoard<Chess::HordeBoard>();
+	if (variant == "berolina")
+		return new TestBoard<Chess::BerolinaBoard>();
+	if (variant == "losers")
+		return new TestBoard<Chess::LosersBoard>();
+	if (variant == "capablanca")
+		return new TestBoard<Chess::CapablancaBoard>();
+	if (variant == "grand")
+		return new TestBoard<Chess::GrandBoard>();
+	if (variant == "amazon")
+		return new TestBoard<Chess::AmazonBoard>();
+	if (variant == "chigorin")
+		return new TestBoard<Chess::ChigorinBoard>();
+	if (variant == "hoppelpoppel")
+		return new TestBoard<Chess::HoppelPoppelBoard>();
+	if (variant == "losalamos")
+		return new TestBoard<Chess::LosAlamosBoard>();
+	if (variant == "pocketknight")
+		return new TestBoard<Chess::PocketKnightBoard>();
+	if (variant == "atomic")
+		return new TestBoard<Chess::AtomicBoard>();
+	if (variant == "5check")
+		return new TestBoard<Chess::FiveCheckBoard>();
+	if (variant == "newzealand")
+		return new TestBoard<Chess::NewZealandBoard>();
+	if (variant == "chessgi")
+		return new TestBoard<Chess::ChessgiBoard>();
+	if (variant == "almost")
+		return new TestBoard<Chess::AlmostBoard>();
+	if (variant == "chancellor")
+		return new TestBoard<Chess::ChancellorBoard>();
+	if (variant == "gustav3")
+		return new TestBoard<Chess::GustavBoard>();
+	if (variant == "janus")
+		return new TestBoard<Chess::JanusBoard>();
+	if (variant == "modern")
+		return new TestBoard<Chess::ModernBoard>();
+	if (variant == "embassy")
+		return new TestBoard<Chess::EmbassyBoard>();
+	if (variant == "gothic")
+		return new TestBoard<Chess::GothicBoard>();
+	return nullptr;
+}
+
+static bool compareMoveSets(Chess::Board* board,
+			    Chess::Board* reference,
+			    int depth)
+{
+	const auto moves = board->legalMoves();
+	const auto refMoves = reference->legalMoves();
+	if (moves.size() != refMoves.size())
+		return false;
+	for (const auto& move : moves)
+	{
+		if (!refMoves.contains(move))
+			return false;
+	}
+	if (depth <= 1)
+		return true;
+
+	for (const auto& move : moves)
+	{
+		board->makeMove(move);
+		reference->makeMove(move);
+		bool ok = compareMoveSets(board, reference, depth - 1);
+		reference->undoMove();
+		board->undoMove();
+		if (!ok)
+			return false;
+	}
+
+	return true;
+}
+
 
 void tst_Board::zobristKeys_data() const
 {
@@ -643,6 +808,69 @@ void tst_Board::moveStrings()
 		QCOMPARE(m_board->fenString(), endfen);
 }
 
+// The number of times \a key occurs in \a keys, counted the way
+// Board::repeatCount() counts it
+static int scanRepeatCount(const QVector<quint64>& keys, quint64 key)
+{
+	if (keys.size() < 4)
+		return 0;
+	return keys.count(key);
+}
+
+void tst_Board::repetitions_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("moves");
+	QTest::addColumn<QString>("startfen");
+	QTest::addColumn<int>("repeatCount");
+
+	QTest::newRow("standard")
+		<< "standard"
+		<< "Nf3 Nf6 Ng1 Ng8 Nf3 Nf6 Ng1 Ng8 e4 e5 Nf3 Nf6 Ng1 Ng8"
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+		<< 1;
+	// The captured knights return to the board as drops
+	QTest::newRow("crazyhouse")
+		<< "crazyhouse"
+		<< "N@d4 N@e6 Nxe6 Kxe6 Ka2 Ke7 Ka1 Kf7"
+		<< "8/5k2/8/8/8/8/8/K7[Nn] w - - 0 1"
+		<< 1;
+}
+
+void tst_Board::repetitions()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, moves);
+	QFETCH(QString, startfen);
+	QFETCH(int, repeatCount);
+
+	setVariant(variant);
+	QVERIFY(m_board->setFenString(startfen));
+
+	// The count must match a scan of the whole history, both when
+	// the moves are made and when they're undone
+	QVector<quint64> keys;
+	const auto moveList = moves.split(' ');
+	for (const auto& moveStr : moveList)
+	{
+		Chess::Move move = m_board->moveFromString(moveStr);
+		QVERIFY(m_board->isLegalMove(move));
+		keys.append(m_board->key());
+		m_board->makeMove(move);
+		QCOMPARE(m_board->repeatCount(),
+			 scanRepeatCount(keys, m_board->key()));
+	}
+	QCOMPARE(m_board->repeatCount(), repeatCount);
+
+	while (!keys.isEmpty())
+	{
+		m_board->undoMove();
+		QCOMPARE(m_board->key(), keys.takeLast());
+		QCOMPARE(m_board->repeatCount(),
+			 scanRepeatCount(keys, m_board->key()));
+	}
+}
+
 void tst_Board::sanStrings_data() const
 {
 	QTest::addColumn<QString>("variant");
@@ -1845,5 +2073,122 @@ void tst_Board::perft()
 	QCOMPARE(smpPerft(m_board, depth), nodecount);
 }
 
+void tst_Board::legalityData(bool smallBoardsOnly) const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<int>("depth");
+
+	QString variant = "standard";
+
+	QTest::newRow("startpos")
+		<< variant
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+		<< 3;
+	QTest::newRow("pos2")
+		<< variant
+		<< "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -"
+		<< 3;
+	QTest::newRow("pos3")
+		<< variant
+		<< "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -"
+		<< 4;
+	QTest::newRow("pos4")
+		<< variant
+		<< "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"
+		<< 3;
+	QTest::newRow("pos5")
+		<< variant
+		<< "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+		<< 3;
+	QTest::newRow("fischerandom")
+		<< "fischerandom"
+		<< "Q3B1kr/p5p1/1p3p1p/2p2P2/2br1N1P/8/P5P1/7K b k - 1 34"
+		<< 3;
+	QTest::newRow("crazyhouse")
+		<< "crazyhouse"
+		<< "r1b2rk1/pppp1ppp/2n5/4p3/1bB1P3/2N2N2/PPPP1qPP/R1B1K2R[QNn] w KQ - 0 8"
+		<< 2;
+
+	// Captures next to the kings, and a capture whose explosion
+	// removes the knight that shields the king from a rook
+	QTest::newRow("atomic pos1")
+		<< "atomic"
+		<< "8/8/8/8/8/8/3k4/rR4K1 w Q - 0 1"
+		<< 3;
+	QTest::newRow("atomic pos2")
+		<< "atomic"
+		<< "r4b1r/2kb1N2/p2Bpnp1/8/2Pp3p/1P1PPP2/P5PP/R3K2R b KQ -"
+		<< 2;
+	QTest::newRow("atomic pin")
+		<< "atomic"
+		<< "k3r3/8/8/8/8/3p4/2P1N3/4K3 w - - 0 1"
+		<< 3;
+
+	QStringList variants = {
+		"loop", "chessgi", "kingofthehill", "3check", "5check",
+		"horde", "berolina", "losers", "amazon", "chigorin",
+		"hoppelpoppel", "newzealand", "losalamos", "pocketknight",
+		"atomic"
+	};
+	if (!smallBoardsOnly)
+		variants << "capablanca" << "embassy" << "gothic" << "grand"
+			 << "almost" << "chancellor" << "gustav3" << "janus"
+			 << "modern";
+	for (const QString& variant : std::as_const(variants))
+		QTest::newRow(variant.toLatin1().constData())
+			<< variant << QString() << 3;
+}
+
+void tst_Board::simpleLegality_data() const
+{
+	legalityData(false);
+}
+
+void tst_Board::simpleLegality()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+	QFETCH(int, depth);
+
+	setVariant(variant);
+	QScopedPointer<Chess::Board> reference(
+		createTestBoard<ReferenceBoard>(variant));
+	QVERIFY(!reference.isNull());
+
+	if (fen.isEmpty())
+		fen = m_board->defaultFenString();
+	QVERIFY(m_board->setFenString(fen));
+	QVERIFY(reference->setFenString(fen));
+	QVERIFY(compareMoveSets(m_board, reference.data(), depth));
+}
+
+void tst_Board::bitboards_data() const
+{
+	// Bitboards are only kept for boards of up to 8x8 squares
+	legalityData(true);
+}
+
+void tst_Board::bitboards()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+	QFETCH(int, depth);
+
+	setVariant(variant);
+	QScopedPointer<Chess::Board> mailbox(
+		createTestBoard<MailboxBoard>(variant));
+	QVERIFY(!mailbox.isNull());
+	QVERIFY(m_board->bitboardsEnabled());
+	QVERIFY(!mailbox->bitboardsEnabled());
+
+	if (fen.isEmpty())
+		fen = m_board->defaultFenString();
+	QVERIFY(m_board->setFenString(fen));
+	QVERIFY(mailbox->setFenString(fen));
+	QVERIFY(compareMoveSets(m_board, mailbox.data(), depth));
+	QCOMPARE(perftVal(m_board, depth), perftVal(mailbox.data(), depth));
+}
+
 QTEST_MAIN(tst_Board)
 #include "tst_board.moc"
@@ -0,0 +1,206 @@
+#include <QtTest/QTest>
+#include <QSignalSpy>
+#include <QTextStream>
+#include <chessgame.h>
+#include <humanplayer.h>
+#include <pgngame.h>
+#include <pgnstream.h>
+#include <timecontrol.h>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+
+class tst_ChessGame: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void lazySan_data() const;
+		void lazySan();
+		void trustedMoves_data() const;
+		void trustedMoves();
+
+	private:
+		bool playGame(const QString& variant,
+			      const QStringList& moves,
+			      int bookPlies,
+			      bool lazySan,
+			      PgnGame* pgn) const;
+};
+
+
+bool tst_ChessGame::playGame(const QString& variant,
+			     const QStringList& moves,
+			     int bookPlies,
+			     bool lazySan,
+			     PgnGame* pgn) const
+{
+	// The moves are converted with a board of their own because
+	// the game's board is reset when the game starts
+	Chess::Board* board = Chess::BoardFactory::create(variant);
+	if (board == nullptr)
+		return false;
+	board->setFenString(board->defaultFenString());
+
+	QVector<Chess::Move> bookMoves;
+	QVector<Chess::GenericMove> humanMoves;
+	for (const QString& str : moves)
+	{
+		Chess::Move move(board->moveFromString(str));
+		if (move.isNull())
+		{
+			delete board;
+			return false;
+		}
+		if (bookMoves.size() < bookPlies)
+			bookMoves.append(move);
+		else
+			humanMoves.append(board->genericMove(move));
+		board->makeMove(move);
+	}
+	delete board;
+
+	ChessGame game(Chess::BoardFactory::create(variant), pgn);
+	HumanPlayer white;
+	HumanPlayer black;
+	game.setPlayer(Chess::Side::White, &white);
+	game.setPlayer(Chess::Side::Black, &black);
+	game.setTimeControl(TimeControl("inf"));
+	game.setMoves(bookMoves);
+	game.setLazySan(lazySan);
+
+	QSignalSpy startedSpy(&game, SIGNAL(started(ChessGame*)));
+	QSignalSpy finishedSpy(&game,
+			       SIGNAL(finished(ChessGame*, Chess::Result)));
+	game.start();
+	if (!startedSpy.wait())
+		return false;
+
+	// Each move is played at once by the player on move
+	for (const auto& move : std::as_const(humanMoves))
+	{
+		Chess::Side side(game.board()->sideToMove());
+		HumanPlayer* player = (side == Chess::Side::White) ? &white : &black;
+		player->onHumanMove(move, side);
+	}
+
+	// Games that don't end on the board are stopped unfinished
+	if (finishedSpy.isEmpty())
+		game.stop();
+	return !finishedSpy.isEmpty() || finishedSpy.wait();
+}
+
+void tst_ChessGame::lazySan_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QStringList>("moves");
+	QTest::addColumn<int>("bookPlies");
+
+	const QStringList legall = QString(
+		"e4 e5 Nf3 d6 Bc4 Bg4 Nc3 g6 Nxe5 Bxd1 Bxf7+ Ke7 Nd5#")
+		.split(' ');
+
+	QTest::newRow("legall's mate")
+		<< QString("standard") << legall << 4;
+	QTest::newRow("legall's mate no book")
+		<< QString("standard") << legall << 0;
+	QTest::newRow("disambiguation")
+		<< QString("standard")
+		<< QString("Nf3 Nf6 Nc3 Nc6 Nd4 Nd5 Ndb5 Ndb4 Nd4 a6 "
+			   "Ncb5 axb5 Nxb5 Rxa2 Rxa2 Nxa2 Nxc7+ Qxc7 "
+			   "e4 Qxh2 Rxh2 Nab4 g3 Nd5 exd5 e6 dxe6 dxe6 "
+			   "f4 Bc5 Rh5 O-O").split(' ')
+		<< 2;
+	QTest::newRow("crazyhouse drops")
+		<< QString("crazyhouse")
+		<< QString("e4 d5 exd5 Qxd5 Nc3 Qd8 P@d5 P@e4").split(' ')
+		<< 2;
+}
+
+void tst_ChessGame::lazySan()
+{
+	QFETCH(QString, variant);
+	QFETCH(QStringList, moves);
+	QFETCH(int, bookPlies);
+
+	PgnGame eager;
+	QVERIFY(playGame(variant, moves, bookPlies, false, &eager));
+	PgnGame lazy;
+	QVERIFY(playGame(variant, moves, bookPlies, true, &lazy));
+
+	QCOMPARE(lazy.moves().size(), eager.moves().size());
+	for (int i = 0; i < eager.moves().size(); i++)
+	{
+		const PgnGame::MoveData& md = lazy.moves().at(i);
+		QCOMPARE(md.moveString, moves.at(i));
+		QCOMPARE(md.moveString, eager.moves().at(i).moveString);
+		QCOMPARE(md.comment, eager.moves().at(i).comment);
+		QCOMPARE(md.key, eager.moves().at(i).key);
+	}
+
+	// The tags that don't depend on the time the game was played
+	const QStringList tags = {
+		"White", "Black", "Result", "Variant", "ECO", "Opening",
+		"Variation", "PlyCount", "TimeControl", "Termination"
+	};
+	for (const QString& tag : tags)
+		QCOMPARE(lazy.tagValue(tag), eager.tagValue(tag));
+
+	QString lazyText;
+	QString eagerText;
+	QTextStream lazyStream(&lazyText);
+	QTextStream eagerStream(&eagerText);
+	QVERIFY(lazy.write(lazyStream, PgnGame::Minimal));
+	QVERIFY(eager.write(eagerStream, PgnGame::Minimal));
+	QCOMPARE(lazyText, eagerText);
+}
+
+void tst_ChessGame::trustedMoves_data() const
+{
+	QTest::addColumn<QString>("pgn");
+	QTest::addColumn<int>("plies");
+
+	QTest::newRow("whole opening")
+		<< QString("1. e4 e5 2. Nf3 Nc6 *\n") << 4;
+	QTest::newRow("threefold repetition")
+		<< QString("1. Nf3 Nf6 2. Ng1 Ng8 3. Nf3 Nf6 4. Ng1 Ng8 "
+			   "5. e4 e5 *\n")
+		<< 7;
+	QTest::newRow("fifty-move rule")
+		<< QString("[FEN \"k7/8/8/8/8/8/8/K6R w - - 98 1\"]\n"
+			   "[SetUp \"1\"]\n\n"
+			   "1. Rh2 Kb8 2. Rh1 Ka8 *\n")
+		<< 1;
+	QTest::newRow("other variant")
+		<< QString("[Variant \"crazyhouse\"]\n\n"
+			   "1. e4 d5 2. exd5 Qxd5 *\n")
+		<< 4;
+}
+
+void tst_ChessGame::trustedMoves()
+{
+	QFETCH(QString, pgn);
+	QFETCH(int, plies);
+
+	const QByteArray data(pgn.toUtf8());
+	PgnStream stream(&data);
+	PgnGame opening;
+	QVERIFY(opening.read(stream));
+
+	PgnGame checkedPgn;
+	ChessGame checked(Chess::BoardFactory::create("standard"),
+			  &checkedPgn);
+	QVERIFY(checked.setMoves(opening));
+
+	// An opening that ends the game is cut where the game ended
+	PgnGame trustedPgn;
+	ChessGame trusted(Chess::BoardFactory::create("standard"),
+			  &trustedPgn);
+	QVERIFY(trusted.setTrustedMoves(opening));
+	QCOMPARE(trusted.moves().size(), plies);
+	QCOMPARE(trusted.moves(), checked.moves());
+	QCOMPARE(trusted.startingFen(), checked.startingFen());
+}
+
+QTEST_MAIN(tst_ChessGame)
+#include "tst_chessgame.moc"
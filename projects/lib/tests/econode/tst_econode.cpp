@@ -0,0 +1,154 @@
+#include <QtTest/QTest>
+#include <econode.h>
+#include <pgngame.h>
+#include <pgnstream.h>
+#include <board/board.h>
+
+
+class tst_EcoNode: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void classify_data() const;
+		void classify();
+
+	private:
+		const EcoNode* treeClassification(const QStringList& moves) const;
+};
+
+
+// The classification before position keys were used: follow the
+// moves down the ECO tree and take the deepest opening on the way
+const EcoNode* tst_EcoNode::treeClassification(const QStringList& moves) const
+{
+	const EcoNode* node = EcoNode::root();
+	const EcoNode* opening = nullptr;
+
+	for (const QString& move : moves)
+	{
+		node = node->child(move);
+		if (node == nullptr)
+			break;
+		if (node->isLeaf())
+			opening = node;
+	}
+
+	return opening;
+}
+
+void tst_EcoNode::initTestCase()
+{
+	EcoNode::initialize();
+	QVERIFY(EcoNode::root() != nullptr);
+	QVERIFY(EcoNode::maxPly() > 0);
+}
+
+void tst_EcoNode::classify_data() const
+{
+	QTest::addColumn<QString>("moves");
+	QTest::addColumn<bool>("transposition");
+	QTest::addColumn<QString>("eco");
+	QTest::addColumn<QString>("opening");
+	QTest::addColumn<QString>("variation");
+
+	// Lines that end in a position that a shorter or an earlier
+	// line of the ECO tree also reaches
+	QTest::newRow("neo-gruenfeld")
+		<< QString("d4 Nf6 c4 g6 g3 d5 Bg2 Bg7")
+		<< false << QString("D70") << QString("Neo-Gruenfeld (Kemeri) defense")
+		<< QString();
+	QTest::newRow("been-koomen")
+		<< QString("d4 d5 c4 e6 Nc3 Nf6 Bg5 c5 Nf3")
+		<< false << QString("D50") << QString("Queen's Gambit declined")
+		<< QString("Been-Koomen variation");
+	QTest::newRow("schlechter")
+		<< QString("d4 d5 c4 c6 Nf3 Nf6 Nc3 g6")
+		<< false << QString("D15") << QString("Queen's Gambit declined")
+		<< QString("Schlechter variation");
+	QTest::newRow("winawer")
+		<< QString("e4 e6 d4 d5 Nc3 Bb4 Nge2")
+		<< false << QString("C15") << QString("French")
+		<< QString("Winawer (Nimzowitsch) variation");
+	QTest::newRow("past the opening")
+		<< QString("e4 c5 Nf3 d6 d4 cxd4 Nxd4 Nf6 Nc3 a6 Be2 e5 Nb3 Be7 "
+		   "O-O O-O Be3 Be6 Qd2 Nbd7 a4 Rc8")
+		<< false << QString("B92") << QString("Sicilian")
+		<< QString("Najdorf, Opovcensky variation");
+
+	// Move orders that leave the ECO tree and reach an opening later
+	QTest::newRow("nimzo-indian from english")
+		<< QString("c4 e6 Nc3 Nf6 d4 Bb4")
+		<< true << QString("E20") << QString("Nimzo-Indian defense")
+		<< QString();
+	QTest::newRow("queen's gambit from reti")
+		<< QString("Nf3 d5 d4 Nf6 c4 e6 Nc3 Be7")
+		<< true << QString("D37") << QString("Queen's Gambit declined")
+		<< QString("4.Nf3");
+	QTest::newRow("breyer")
+		<< QString("e4 e5 Nf3 Nc6 Bb5 a6 Ba4 Nf6 O-O Be7 Re1 b5 Bb3 d6 "
+		   "c3 O-O h3 Nb8 d4 Nbd7")
+		<< true << QString("C95") << QString("Ruy Lopez")
+		<< QString("Closed, Breyer, Borisenko variation");
+}
+
+void tst_EcoNode::classify()
+{
+	QFETCH(QString, moves);
+	QFETCH(bool, transposition);
+	QFETCH(QString, eco);
+	QFETCH(QString, opening);
+	QFETCH(QString, variation);
+
+	const QStringList moveList(moves.split(' '));
+	QString text("[Event \"?\"]\n\n");
+	for (int i = 0; i < moveList.size(); i++)
+	{
+		if (i % 2 == 0)
+			text += QString::number(i / 2 + 1) + ". ";
+		text += moveList.at(i) + ' ';
+	}
+	text += "*\n";
+
+	const QByteArray data(text.toUtf8());
+	PgnStream stream(&data);
+	PgnGame game;
+	QVERIFY(game.read(stream));
+	QCOMPARE(game.moves().size(), moveList.size());
+
+	QCOMPARE(game.tagValue("ECO"), eco);
+	QCOMPARE(game.tagValue("Opening"), opening);
+	QCOMPARE(game.tagValue("Variation"), variation);
+
+	// Games that follow the tree get the same opening as before
+	const EcoNode* node = treeClassification(moveList);
+	if (transposition)
+		QVERIFY(node == nullptr || node->ecoCode() != eco);
+	else
+	{
+		QVERIFY(node != nullptr);
+		QCOMPARE(node->ecoCode(), eco);
+		QCOMPARE(node->opening(), opening);
+		QCOMPARE(node->variation(), variation);
+	}
+
+	// Moves added without opening information, like with lazy SAN
+	PgnGame lazy;
+	for (const PgnGame::MoveData& md : game.moves())
+		lazy.addMove(md, false);
+	QVERIFY(lazy.tagValue("ECO").isEmpty());
+	lazy.updateEco();
+	lazy.addEcoPosition(stream.board()->key());
+	QCOMPARE(lazy.tagValue("ECO"), eco);
+	QCOMPARE(lazy.tagValue("Opening"), opening);
+	QCOMPARE(lazy.tagValue("Variation"), variation);
+
+	// Classifying the final position again doesn't change it
+	game.addEcoPosition(stream.board()->key());
+	QCOMPARE(game.tagValue("ECO"), eco);
+	QCOMPARE(game.tagValue("Variation"), variation);
+}
+
+QTEST_MAIN(tst_EcoNode)
+#include "tst_econode.moc"
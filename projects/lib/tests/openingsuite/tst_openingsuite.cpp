@@ -0,0 +1,263 @@
+#include <QtTest/QTest>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QTemporaryDir>
+#include <openingsuite.h>
+
+
+class tst_OpeningSuite: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void index_data() const;
+		void index();
+		void invalidation_data() const;
+		void invalidation();
+
+	private:
+		QString suiteFileName(OpeningSuite::Format format);
+		bool writeSuite(const QString& fileName,
+				OpeningSuite::Format format,
+				const QList<int>& openings) const;
+		QStringList readSuite(const QString& fileName,
+				      OpeningSuite::Format format) const;
+		QString openingId(const PgnGame& game) const;
+		QByteArray readFile(const QString& fileName) const;
+
+		QTemporaryDir m_dir;
+		int m_fileCount = 0;
+};
+
+
+QString tst_OpeningSuite::suiteFileName(OpeningSuite::Format format)
+{
+	const QString suffix = (format == OpeningSuite::PgnFormat) ? "pgn" : "epd";
+	return m_dir.filePath(QString("suite%1.%2").arg(m_fileCount++).arg(suffix));
+}
+
+bool tst_OpeningSuite::writeSuite(const QString& fileName,
+				  OpeningSuite::Format format,
+				  const QList<int>& openings) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+
+	// The openings have different lengths, so their file positions
+	// change when they're reordered
+	QByteArray data;
+	for (int i : openings)
+	{
+		const QByteArray padding(i + 1, '-');
+		const QByteArray num(QByteArray::number(i));
+		if (format == OpeningSuite::PgnFormat)
+			data += "[Event \"Opening " + num + "\"]\n"
+				"[Result \"*\"]\n\n"
+				"1. e4 {" + padding + "} *\n\n";
+		else
+			data += "k7/8/8/8/8/8/8/K7 w - - hmvc " + num + "; "
+				"c0 \"" + padding + "\";\n";
+	}
+
+	return file.write(data) == data.size();
+}
+
+QStringList tst_OpeningSuite::readSuite(const QString& fileName,
+					OpeningSuite::Format format) const
+{
+	// Read the openings in sequential order until the suite wraps
+	OpeningSuite suite(fileName, format);
+	QStringList openings;
+	if (!suite.initialize())
+		return openings;
+
+	for (int i = 0; i < 100; i++)
+	{
+		const PgnGame game(suite.nextGame(INT_MAX));
+		if (suite.currentIndex() != openings.size())
+			break;
+		openings << openingId(game);
+	}
+
+	return openings;
+}
+
+QString tst_OpeningSuite::openingId(const PgnGame& game) const
+{
+	const QString event(game.tagValue("Event"));
+	return event.isEmpty() ? game.startingFenString() : event;
+}
+
+QByteArray tst_OpeningSuite::readFile(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	return file.readAll();
+}
+
+void tst_OpeningSuite::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+}
+
+void tst_OpeningSuite::index_data() const
+{
+	QTest::addColumn<int>("format");
+	QTest::addColumn<int>("startIndex");
+	QTest::addColumn<int>("expectedIndex");
+
+	const QList<OpeningSuite::Format> formats = {
+		OpeningSuite::PgnFormat, OpeningSuite::EpdFormat
+	};
+	for (OpeningSuite::Format format : formats)
+	{
+		const QByteArray name(format == OpeningSuite::PgnFormat
+				      ? "pgn" : "epd");
+		QTest::newRow((name + " first").constData())
+			<< int(format) << 0 << 0;
+		QTest::newRow((name + " middle").constData())
+			<< int(format) << 2 << 2;
+		QTest::newRow((name + " last").constData())
+			<< int(format) << 4 << 4;
+		QTest::newRow((name + " wrap").constData())
+			<< int(format) << 7 << 2;
+	}
+}
+
+void tst_OpeningSuite::index()
+{
+	QFETCH(int, format);
+	QFETCH(int, startIndex);
+	QFETCH(int, expectedIndex);
+
+	const auto suiteFormat = OpeningSuite::Format(format);
+	const QString fileName(suiteFileName(suiteFormat));
+	QVERIFY(writeSuite(fileName, suiteFormat, { 0, 1, 2, 3, 4 }));
+	const QStringList openings(readSuite(fileName, suiteFormat));
+	QCOMPARE(openings.size(), 5);
+
+	const QString indexFile(OpeningSuite::indexFileName(fileName));
+	QVERIFY(!QFile::exists(indexFile));
+	QVERIFY(OpeningSuite::buildIndex(fileName, suiteFormat));
+	QVERIFY(QFile::exists(indexFile));
+
+	// The start offset is read from the index
+	OpeningSuite suite(fileName, suiteFormat,
+			   OpeningSuite::SequentialOrder, startIndex);
+	if (startIndex >= openings.size())
+		QTest::ignoreMessage(QtWarningMsg, "Start index larger than "
+				     "book size, wrapping after 5.");
+	QVERIFY(suite.initialize());
+	for (int i = 0; i < openings.size(); i++)
+	{
+		const PgnGame game(suite.nextGame(INT_MAX));
+		const int index = (expectedIndex + i) % openings.size();
+		QCOMPARE(suite.currentIndex(), index);
+		QCOMPARE(openingId(game), openings.at(index));
+	}
+
+	// Every opening is picked once in random order
+	OpeningSuite random(fileName, suiteFormat, OpeningSuite::RandomOrder);
+	QVERIFY(random.initialize());
+	QSet<int> indexes;
+	for (int i = 0; i < openings.size(); i++)
+	{
+		const PgnGame game(random.nextGame(INT_MAX));
+		QCOMPARE(openingId(game), openings.at(random.currentIndex()));
+		indexes.insert(random.currentIndex());
+	}
+	QCOMPARE(indexes.size(), openings.size());
+}
+
+void tst_OpeningSuite::invalidation_data() const
+{
+	QTest::addColumn<int>("format");
+	QTest::addColumn<bool>("keepSizeAndTime");
+
+	QTest::newRow("pgn new opening")
+		<< int(OpeningSuite::PgnFormat) << false;
+	QTest::newRow("pgn same size and time")
+		<< int(OpeningSuite::PgnFormat) << true;
+	QTest::newRow("epd new opening")
+		<< int(OpeningSuite::EpdFormat) << false;
+	QTest::newRow("epd same size and time")
+		<< int(OpeningSuite::EpdFormat) << true;
+}
+
+void tst_OpeningSuite::invalidation()
+{
+	QFETCH(int, format);
+	QFETCH(bool, keepSizeAndTime);
+
+	const auto suiteFormat = OpeningSuite::Format(format);
+	const QString fileName(suiteFileName(suiteFormat));
+	const QString indexFile(OpeningSuite::indexFileName(fileName));
+	QVERIFY(writeSuite(fileName, suiteFormat, { 0, 1, 2, 3, 4 }));
+	QVERIFY(OpeningSuite::buildIndex(fileName, suiteFormat));
+	const QByteArray oldIndex(readFile(indexFile));
+	QVERIFY(!oldIndex.isEmpty());
+
+	// Change the suite after the index was built
+	if (keepSizeAndTime)
+	{
+		const QDateTime modified(QFileInfo(fileName).lastModified());
+		QVERIFY(writeSuite(fileName, suiteFormat, { 4, 3, 2, 1, 0 }));
+
+		QFile file(fileName);
+		QVERIFY(file.open(QIODevice::ReadWrite));
+		QVERIFY(file.setFileTime(modified,
+					 QFileDevice::FileModificationTime));
+		file.close();
+		QCOMPARE(QFileInfo(fileName).lastModified(), modified);
+	}
+	else
+		QVERIFY(writeSuite(fileName, suiteFormat, { 5, 0, 1, 2, 3, 4 }));
+
+	const QStringList openings(readSuite(fileName, suiteFormat));
+	QCOMPARE(openings.size(), keepSizeAndTime ? 5 : 6);
+
+	// The stale index is ignored
+	OpeningSuite suite(fileName, suiteFormat,
+			   OpeningSuite::SequentialOrder, 1);
+	QVERIFY(suite.initialize());
+	PgnGame game(suite.nextGame(INT_MAX));
+	QCOMPARE(suite.currentIndex(), 1);
+	QCOMPARE(openingId(game), openings.at(1));
+	QCOMPARE(readFile(indexFile), oldIndex);
+
+	// A random order suite doesn't touch the index by default
+	OpeningSuite random(fileName, suiteFormat, OpeningSuite::RandomOrder);
+	QVERIFY(random.initialize());
+	QCOMPARE(readFile(indexFile), oldIndex);
+	for (int i = 0; i < openings.size(); i++)
+	{
+		game = random.nextGame(INT_MAX);
+		QCOMPARE(openingId(game), openings.at(random.currentIndex()));
+	}
+
+	// With index saving the stale index is replaced with a new one
+	OpeningSuite saving(fileName, suiteFormat, OpeningSuite::RandomOrder);
+	saving.setIndexSavingEnabled(true);
+	QVERIFY(saving.initialize());
+	QVERIFY(readFile(indexFile) != oldIndex);
+	for (int i = 0; i < openings.size(); i++)
+	{
+		game = saving.nextGame(INT_MAX);
+		QCOMPARE(openingId(game), openings.at(saving.currentIndex()));
+	}
+
+	OpeningSuite indexed(fileName, suiteFormat,
+			     OpeningSuite::SequentialOrder, 3);
+	QVERIFY(indexed.initialize());
+	game = indexed.nextGame(INT_MAX);
+	QCOMPARE(indexed.currentIndex(), 3);
+	QCOMPARE(openingId(game), openings.at(3));
+}
+
+QTEST_MAIN(tst_OpeningSuite)
+#include "tst_openingsuite.moc"
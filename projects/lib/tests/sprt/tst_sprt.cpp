@@ -9,6 +9,10 @@ class tst_Sprt: public QObject
 	private slots:
 		void sprt_data() const;
 		void sprt();
+		void pentanomial_data() const;
+		void pentanomial();
+		void expectedResult_data() const;
+		void expectedResult();
 
 	private:
 		bool fuzzyCompare(double val1, double val2);
@@ -100,5 +104,160 @@ void tst_Sprt::sprt()
 	QVERIFY(fuzzyCompare(status.uBound, ubound));
 }
 
+void tst_Sprt::pentanomial_data() const
+{
+	QTest::addColumn<double>("elo0");
+	QTest::addColumn<double>("elo1");
+	QTest::addColumn<int>("ll");
+	QTest::addColumn<int>("ld");
+	QTest::addColumn<int>("dd");
+	QTest::addColumn<int>("wd");
+	QTest::addColumn<int>("ww");
+	QTest::addColumn<double>("llr");
+
+	// The LLR values were computed independently of this
+	// implementation with the GSPRT approximation
+	// pairs / 2 * log((1 + (t - t0)^2) / (1 + (t - t1)^2)),
+	// where t is the normalized score per game pair
+	QTest::newRow("test1")
+		<< 0.0
+		<< 5.0
+		<< 100
+		<< 900
+		<< 2600
+		<< 1050
+		<< 110
+		<< 3.53;
+
+	QTest::newRow("test2")
+		<< 0.0
+		<< 5.0
+		<< 300
+		<< 800
+		<< 2000
+		<< 800
+		<< 300
+		<< -0.87;
+
+	QTest::newRow("test3")
+		<< 0.0
+		<< 5.0
+		<< 60
+		<< 600
+		<< 1000
+		<< 300
+		<< 20
+		<< -9.89;
+
+	QTest::newRow("test4")
+		<< 0.5
+		<< 2.5
+		<< 400
+		<< 5000
+		<< 12000
+		<< 5200
+		<< 420
+		<< 1.41;
+
+	QTest::newRow("empty")
+		<< 0.0
+		<< 5.0
+		<< 0
+		<< 0
+		<< 0
+		<< 0
+		<< 0
+		<< 0.0;
+}
+
+void tst_Sprt::pentanomial()
+{
+	QFETCH(double, elo0);
+	QFETCH(double, elo1);
+	QFETCH(int, ll);
+	QFETCH(int, ld);
+	QFETCH(int, dd);
+	QFETCH(int, wd);
+	QFETCH(int, ww);
+	QFETCH(double, llr);
+
+	Sprt sprt;
+	sprt.initialize(elo0, elo1, 0.05, 0.05);
+	sprt.setModel(Sprt::Pentanomial);
+
+	for (int i = 0; i < ll; i++)
+		sprt.addGamePairResult(Sprt::Loss, Sprt::Loss);
+	for (int i = 0; i < ld; i++)
+		sprt.addGamePairResult(Sprt::Draw, Sprt::Loss);
+	for (int i = 0; i < dd; i++)
+	{
+		if (i % 2)
+			sprt.addGamePairResult(Sprt::Draw, Sprt::Draw);
+		else
+			sprt.addGamePairResult(Sprt::Loss, Sprt::Win);
+	}
+	for (int i = 0; i < wd; i++)
+		sprt.addGamePairResult(Sprt::Win, Sprt::Draw);
+	for (int i = 0; i < ww; i++)
+		sprt.addGamePairResult(Sprt::Win, Sprt::Win);
+
+	// Pairs with an unfinished game are ignored
+	sprt.addGamePairResult(Sprt::Win, Sprt::NoResult);
+	QCOMPARE(sprt.gameCount(), (ll + ld + dd + wd + ww) * 2);
+
+	Sprt::Status status = sprt.status();
+	QVERIFY(fuzzyCompare(status.llr, llr));
+	QVERIFY(fuzzyCompare(status.lBound, -2.94));
+	QVERIFY(fuzzyCompare(status.uBound, 2.94));
+}
+
+void tst_Sprt::expectedResult_data() const
+{
+	QTest::addColumn<int>("wins");
+	QTest::addColumn<int>("losses");
+	QTest::addColumn<int>("draws");
+	QTest::addColumn<int>("games");
+	QTest::addColumn<int>("result");
+
+	// With the results of "test1" the LLR reaches the upper
+	// bound after about 4740 more games
+	QTest::newRow("test1 no games")
+		<< 1477 << 1351 << 2942 << 0 << int(Sprt::Continue);
+	QTest::newRow("test1 short")
+		<< 1477 << 1351 << 2942 << 4000 << int(Sprt::Continue);
+	QTest::newRow("test1 long")
+		<< 1477 << 1351 << 2942 << 5000 << int(Sprt::AcceptH1);
+	QTest::newRow("test1 beyond trajectory")
+		<< 1477 << 1351 << 2942 << 6000 << int(Sprt::Continue);
+	QTest::newRow("test2")
+		<< 555 << 555 << 298 << 1400 << int(Sprt::Continue);
+	QTest::newRow("test3 concluded")
+		<< 3 << 149 << 1 << 0 << int(Sprt::AcceptH0);
+	QTest::newRow("empty")
+		<< 0 << 0 << 0 << 100 << int(Sprt::Continue);
+}
+
+void tst_Sprt::expectedResult()
+{
+	QFETCH(int, wins);
+	QFETCH(int, losses);
+	QFETCH(int, draws);
+	QFETCH(int, games);
+	QFETCH(int, result);
+
+	Sprt sprt;
+	sprt.initialize(0.0, 10.0, 0.01, 0.01);
+
+	for (int i = 0; i < wins; i++)
+		sprt.addGameResult(Sprt::Win);
+	for (int i = 0; i < losses; i++)
+		sprt.addGameResult(Sprt::Loss);
+	for (int i = 0; i < draws; i++)
+		sprt.addGameResult(Sprt::Draw);
+
+	QCOMPARE(sprt.gameCount(), wins + losses + draws);
+	QCOMPARE(int(sprt.expectedResult(games)), result);
+}
+
 QTEST_MAIN(tst_Sprt)
 #include "tst_sprt.moc"
@@ -15,6 +15,9 @@ class tst_Tb: public QObject
 		
 		void positions_data() const;
 		void positions();
+		void wdlPositions_data() const;
+		void wdlPositions();
+		void probeCache();
 		
 		void cleanupTestCase();
 		
@@ -35,6 +38,7 @@ void tst_Tb::initTestCase()
 
 void tst_Tb::cleanupTestCase()
 {
+	SyzygyTablebase::setCacheSize(0);
 }
 
 void tst_Tb::tbInitialized()
@@ -118,5 +122,42 @@ void tst_Tb::positions()
 	QCOMPARE(int(tbDtz), dtz);
 }
 
+void tst_Tb::wdlPositions_data() const
+{
+	positions_data();
+}
+
+void tst_Tb::wdlPositions()
+{
+	QFETCH(QString, fen);
+	QFETCH(QString, result);
+
+	// Without a DTZ request a plain WDL probe is used where possible
+	QVERIFY(m_board.setFenString(fen));
+	QCOMPARE(m_board.tablebaseResult().toShortString(), result);
+}
+
+void tst_Tb::probeCache()
+{
+	SyzygyTablebase::setCacheSize(1024);
+	QVERIFY(m_board.setFenString("1n6/8/8/8/8/8/6R1/2K1k3 w - - 0 1"));
+
+	auto before = SyzygyTablebase::probeStats();
+	QCOMPARE(m_board.tablebaseResult().toShortString(), QString("1-0"));
+	QCOMPARE(m_board.tablebaseResult().toShortString(), QString("1-0"));
+	auto after = SyzygyTablebase::probeStats();
+
+	QCOMPARE(after.probes - before.probes, quint64(2));
+	QCOMPARE(after.cacheHits - before.cacheHits, quint64(1));
+
+	// Probes that need the DTZ bypass the cache
+	unsigned int dtz = 0;
+	QCOMPARE(m_board.tablebaseResult(&dtz).toShortString(), QString("1-0"));
+	QCOMPARE(int(dtz), 48);
+	QCOMPARE(SyzygyTablebase::probeStats().cacheHits, after.cacheHits);
+
+	SyzygyTablebase::setCacheSize(0);
+}
+
 QTEST_MAIN(tst_Tb)
 #include "tst_tb.moc"
@@ -0,0 +1,192 @@
+#include <QtTest/QTest>
+#include <climits>
+#include <QAtomicInt>
+#include <QSignalSpy>
+#include <chessplayer.h>
+#include <gamemanager.h>
+#include <playerbuilder.h>
+#include <sprt.h>
+#include <timecontrol.h>
+#include <tournament.h>
+#include <tournamentfactory.h>
+#include <board/board.h>
+
+
+// The number of games lost by resignation in the current test
+static QAtomicInt s_resignations;
+// The weak player wins after this many resignations
+static int s_weakWinsAfter;
+
+class MockPlayer: public ChessPlayer
+{
+	Q_OBJECT
+
+	public:
+		MockPlayer(bool weak, QObject* parent)
+			: ChessPlayer(parent),
+			  m_weak(weak)
+		{
+			setState(Idle);
+		}
+
+		virtual void endGame(const Chess::Result& result)
+		{
+			ChessPlayer::endGame(result);
+			setState(Idle);
+		}
+		virtual void makeMove(const Chess::Move& move)
+		{
+			Q_UNUSED(move);
+		}
+		virtual bool supportsVariant(const QString& variant) const
+		{
+			return variant == "standard";
+		}
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+
+	protected:
+		virtual void startGame()
+		{
+		}
+		virtual void startThinking()
+		{
+			QMetaObject::invokeMethod(this, "play", Qt::QueuedConnection);
+		}
+
+	private slots:
+		void play()
+		{
+			if (state() != Thinking)
+				return;
+
+			// The loser resigns and the winner plays on
+			const bool weakLoses = s_resignations.loadRelaxed() < s_weakWinsAfter;
+			if (m_weak == weakLoses)
+			{
+				s_resignations.ref();
+				claimResult(Chess::Result(Chess::Result::Resignation,
+							  side().opposite()));
+			}
+			else
+				emitMove(board()->legalMoves().first());
+		}
+
+	private:
+		bool m_weak;
+};
+
+class MockPlayerBuilder: public PlayerBuilder
+{
+	public:
+		MockPlayerBuilder(const QString& name, bool weak)
+			: PlayerBuilder(name),
+			  m_weak(weak)
+		{
+		}
+
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+
+		virtual ChessPlayer* create(QObject* receiver,
+					    const char* method,
+					    QObject* parent,
+					    QString* error) const
+		{
+			Q_UNUSED(receiver);
+			Q_UNUSED(method);
+			Q_UNUSED(error);
+
+			ChessPlayer* player = new MockPlayer(m_weak, parent);
+			player->setName(name());
+			return player;
+		}
+
+	private:
+		bool m_weak;
+};
+
+class tst_Tournament: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void sprtDrain_data() const;
+		void sprtDrain();
+};
+
+
+void tst_Tournament::sprtDrain_data() const
+{
+	QTest::addColumn<bool>("drain");
+	QTest::addColumn<int>("concurrency");
+	QTest::addColumn<int>("weakWinsAfter");
+	QTest::addColumn<int>("result");
+
+	QTest::newRow("no drain")
+		<< false << 8 << INT_MAX << int(Sprt::AcceptH1);
+	QTest::newRow("drain")
+		<< true << 8 << INT_MAX << int(Sprt::AcceptH1);
+	QTest::newRow("drain single game")
+		<< true << 1 << INT_MAX << int(Sprt::AcceptH1);
+	// The trend turns around just below the upper bound, where the
+	// games in progress are expected to conclude the test. When they
+	// don't, new games have to be started again.
+	QTest::newRow("drain resume")
+		<< true << 8 << 80 << int(Sprt::AcceptH0);
+}
+
+void tst_Tournament::sprtDrain()
+{
+	QFETCH(bool, drain);
+	QFETCH(int, concurrency);
+	QFETCH(int, weakWinsAfter);
+	QFETCH(int, result);
+
+	s_resignations.storeRelaxed(0);
+	s_weakWinsAfter = weakWinsAfter;
+
+	GameManager manager;
+	manager.setConcurrency(concurrency);
+
+	Tournament* tournament = TournamentFactory::create("round-robin",
+							   &manager);
+	QVERIFY(tournament != nullptr);
+	tournament->addPlayer(new MockPlayerBuilder("Strong", false),
+			      TimeControl("inf"));
+	tournament->addPlayer(new MockPlayerBuilder("Weak", true),
+			      TimeControl("inf"));
+	tournament->setGamesPerEncounter(2);
+	tournament->setRoundMultiplier(1000);
+	tournament->sprt()->initialize(0.0, 10.0, 0.05, 0.05);
+	tournament->setSprtDrainEnabled(drain);
+
+	QSignalSpy startedSpy(tournament,
+			      SIGNAL(gameStarted(ChessGame*, int, int, int)));
+	QSignalSpy finishedSpy(tournament, SIGNAL(finished()));
+	QMetaObject::invokeMethod(tournament, "start", Qt::QueuedConnection);
+	QVERIFY(finishedSpy.wait(60000));
+
+	const Sprt* sprt = tournament->sprt();
+	QCOMPARE(int(sprt->status().result), result);
+	QVERIFY(tournament->finishedGameCount() < tournament->finalGameCount());
+	if (drain)
+	{
+		// Every game that was started is played to the end and
+		// counted in the test
+		QCOMPARE(tournament->finishedGameCount(), startedSpy.count());
+		QCOMPARE(sprt->gameCount(), startedSpy.count());
+	}
+
+	QSignalSpy managerSpy(&manager, SIGNAL(finished()));
+	manager.finish();
+	QVERIFY(!managerSpy.isEmpty() || managerSpy.wait());
+	delete tournament;
+}
+
+QTEST_MAIN(tst_Tournament)
+#include "tst_tournament.moc"
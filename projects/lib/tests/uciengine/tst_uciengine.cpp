@@ -1,8 +1,10 @@
 #include <QtTest/QTest>
+#include <QSignalSpy>
 #include <uciengine.h>
 #include <board/board.h>
 #include <board/boardfactory.h>
 #include <moveevaluation.h>
+#include <timecontrol.h>
 #include <enginebuttonoption.h>
 #include <enginecheckoption.h>
 #include <enginespinoption.h>
@@ -19,6 +21,7 @@ class tst_UciEngine: public UciEngine
 	private slots:
 		void testParseInfo_data();
 		void testParseInfo();
+		void testMultiPv();
 		void testParseOptionButton_data();
 		void testParseOptionButton();
 		void testParseOptionCheck_data();
@@ -40,11 +43,13 @@ void tst_UciEngine::testParseInfo_data()
 {
 	QTest::addColumn<QString>("infoString");
 	QTest::addColumn<MoveEvaluation>("eval");
+	QTest::addColumn<QString>("san");
 
 	// "string" info is not parsed and yields an empty evaluation
 	QTest::newRow("string")
 	    << "info string NNUE evaluation using nn-5af11540bbfe.nnue enabled"
-	    << MoveEvaluation();
+	    << MoveEvaluation()
+	    << QString();
 
 	MoveEvaluation eval1;
 	eval1.setDepth(1);
@@ -56,11 +61,12 @@ void tst_UciEngine::testParseInfo_data()
 	eval1.setHashUsage(0);
 	eval1.setTbHits(0);
 	eval1.setTime(1);
-	eval1.setPv("Nf3");
+	eval1.setPv("g1f3");
 	QTest::newRow("depth 1")
 	    << "info depth 1 seldepth 1 multipv 1 score cp 2 nodes 20 "
 	       "nps 20000 hashfull 0 tbhits 0 time 1 pv g1f3"
-	    << eval1;
+	    << eval1
+	    << "Nf3";
 
 	MoveEvaluation eval2;
 	eval2.setDepth(5);
@@ -72,11 +78,12 @@ void tst_UciEngine::testParseInfo_data()
 	eval2.setHashUsage(0);
 	eval2.setTbHits(0);
 	eval2.setTime(1);
-	eval2.setPv("e4 Nf6");
+	eval2.setPv("e2e4 g8f6");
 	QTest::newRow("short pv")
 	    << "info depth 5 seldepth 3 multipv 1 score cp 42 nodes 131 "
 	       "nps 131000 hashfull 0 tbhits 0 time 1 pv e2e4 g8f6"
-	    << eval2;
+	    << eval2
+	    << "e4 Nf6";
 
 	MoveEvaluation eval3;
 	eval3.setDepth(9);
@@ -88,12 +95,13 @@ void tst_UciEngine::testParseInfo_data()
 	eval3.setHashUsage(1);
 	eval3.setTbHits(0);
 	eval3.setTime(9);
-	eval3.setPv("e4 e5 Nf3 Nf6 Nxe5 Nxe4 d4 Nc6");
+	eval3.setPv("e2e4 e7e5 g1f3 g8f6 f3e5 f6e4 d2d4 b8c6");
 	QTest::newRow("long pv")
 	    << "info depth 9 seldepth 8 multipv 1 score cp 48 nodes 4500 "
 	       "nps 500000 hashfull 1 tbhits 0 time 9 "
 	       "pv e2e4 e7e5 g1f3 g8f6 f3e5 f6e4 d2d4 b8c6"
-	    << eval3;
+	    << eval3
+	    << "e4 e5 Nf3 Nf6 Nxe5 Nxe4 d4 Nc6";
 
 	// Mate scores: a positive mate in N is mapped close to MATE_SCORE
 	MoveEvaluation eval4;
@@ -106,11 +114,12 @@ void tst_UciEngine::testParseInfo_data()
 	eval4.setHashUsage(0);
 	eval4.setTbHits(0);
 	eval4.setTime(100);
-	eval4.setPv("e4");
+	eval4.setPv("e2e4");
 	QTest::newRow("mate")
 	    << "info depth 20 seldepth 25 multipv 1 score mate 5 nodes 1000 "
 	       "nps 1000 hashfull 0 tbhits 0 time 100 pv e2e4"
-	    << eval4;
+	    << eval4
+	    << "e4";
 
 	// A negative mate (getting mated) maps close to -MATE_SCORE
 	MoveEvaluation eval5;
@@ -123,11 +132,12 @@ void tst_UciEngine::testParseInfo_data()
 	eval5.setHashUsage(0);
 	eval5.setTbHits(0);
 	eval5.setTime(100);
-	eval5.setPv("e4");
+	eval5.setPv("e2e4");
 	QTest::newRow("mated")
 	    << "info depth 20 seldepth 25 multipv 1 score mate -2 nodes 1000 "
 	       "nps 1000 hashfull 0 tbhits 0 time 100 pv e2e4"
-	    << eval5;
+	    << eval5
+	    << "e4";
 
 	// Secondary PVs (multipv > 1) are parsed the same way
 	MoveEvaluation eval6;
@@ -140,25 +150,78 @@ void tst_UciEngine::testParseInfo_data()
 	eval6.setHashUsage(0);
 	eval6.setTbHits(0);
 	eval6.setTime(1);
-	eval6.setPv("d4");
+	eval6.setPv("d2d4");
 	QTest::newRow("multipv 2")
 	    << "info depth 5 seldepth 3 multipv 2 score cp 30 nodes 200 "
 	       "nps 200000 hashfull 0 tbhits 0 time 1 pv d2d4"
-	    << eval6;
+	    << eval6
+	    << "d4";
 }
 
 void tst_UciEngine::testParseInfo()
 {
 	QFETCH(QString, infoString);
 	QFETCH(MoveEvaluation, eval);
+	QFETCH(QString, san);
 
-	// parseInfo() converts the PV to SAN, which requires a board
+	// parseInfo() keeps the PV in the engine's notation; converting
+	// it to SAN requires a board
 	Chess::Board* board = Chess::BoardFactory::create("standard");
 	QVERIFY(board != nullptr);
 	QVERIFY(board->setFenString(board->defaultFenString()));
 	setBoard(board);
 
-	QCOMPARE(parseInfo(infoString), eval);
+	MoveEvaluation parsed(parseInfo(infoString));
+	QCOMPARE(parsed, eval);
+	QCOMPARE(sanPv(parsed.pv()), san);
+
+	setBoard(nullptr);
+	delete board;
+}
+
+void tst_UciEngine::testMultiPv()
+{
+	Chess::Board* board = Chess::BoardFactory::create("standard");
+	QVERIFY(board != nullptr);
+	QVERIFY(board->setFenString(board->defaultFenString()));
+	setBoard(board);
+
+	setTimeControl(TimeControl("inf"));
+	setState(Thinking);
+
+	// Without thinking listeners the PVs are kept in the engine's
+	// notation until the engine sends its move
+	parseLine("info depth 10 multipv 1 score cp 35 time 1500 "
+		  "pv e2e4 e7e5 g1f3");
+	parseLine("info depth 10 multipv 2 score cp 20 time 1500 "
+		  "pv d2d4 d7d5");
+	parseLine("info depth 10 multipv 3 score cp -5 time 1500 "
+		  "pv g1f3 g8f6");
+
+	const MoveEvaluation& eval = evaluation();
+	QVERIFY(eval.pv().isEmpty());
+	QVERIFY(eval.pvLine(1).pv.isEmpty());
+	QCOMPARE(eval.score(), 35);
+
+	QSignalSpy moveSpy(this, SIGNAL(moveMade(Chess::Move)));
+	parseLine("bestmove e2e4");
+	QCOMPARE(moveSpy.count(), 1);
+	QCOMPARE(eval.pv(), QString("e4 e5 Nf3"));
+	QCOMPARE(eval.score(), 35);
+	QCOMPARE(eval.depth(), 10);
+	QCOMPARE(eval.pvLineCount(), 3);
+
+	QCOMPARE(eval.pvLine(0).pv, eval.pv());
+	QCOMPARE(eval.pvLine(0).score, 35);
+	QCOMPARE(eval.pvLine(1).pv, QString("d4 d5"));
+	QCOMPARE(eval.pvLine(1).score, 20);
+	QCOMPARE(eval.pvLine(1).depth, 10);
+	QCOMPARE(eval.pvLine(2).pv, QString("Nf3 Nf6"));
+	QCOMPARE(eval.pvLine(2).score, -5);
+
+	QCOMPARE(eval.pgnComment(),
+		 QString("+0.35/10 0s; 2: +0.20/10 d4 d5; "
+			 "3: -0.05/10 Nf3 Nf6"));
 
 	setBoard(nullptr);
 	delete board;